@@ -76,7 +76,7 @@ public:
 	~OdometerInstrument_Button(void);
 
 	wxSize GetSize(int orient, wxSize hint);
-	void SetData(int, double, wxString);
+	void SetData(int, double, const wxString &);
     void OnButtonClickTripReset( wxCommandEvent& event);
     void OnButtonClickStartStop( wxCommandEvent& event);
     void OnButtonClickLegReset( wxCommandEvent& event);
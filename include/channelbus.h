@@ -0,0 +1,72 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _CHANNELBUS_H_
+#define _CHANNELBUS_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+// One channel per OCPN_DBP_STC_ bit, checked against them in instrument.h
+#define ODOMETER_CHANNEL_COUNT 10
+
+// Last value published on a channel
+struct OdometerChannel {
+	unsigned long Version;      // Bus sequence of the last change, 0 until first published
+	double   Value;
+	wxString Text;              // Unit, or the whole text of a string instrument
+};
+
+//
+// CLASS:
+//    OdometerChannelBus
+//
+// DESCRIPTION:
+//    Latest value of every instrument channel, keyed by its OCPN_DBP_STC_ bit.
+//    The plugin publishes into it and every instrument pulls the channels of
+//    its capability flags whose version moved since it last looked. A value
+//    published again unchanged keeps its version, so it is not passed on.
+//    Only used from the GUI thread, it takes no locks.
+//
+class OdometerChannelBus {
+public:
+	OdometerChannelBus();
+
+	static int ChannelIndex(int channel);
+
+	bool Publish(int channel, double value, const wxString &text);
+	unsigned long GetSequence() const { return m_Sequence; }
+	const OdometerChannel &GetChannel(int index) const { return m_Channels[index]; }
+
+private:
+	OdometerChannel m_Channels[ODOMETER_CHANNEL_COUNT];
+	unsigned long m_Sequence;   // Version of the latest change on any channel
+};
+
+#endif // _CHANNELBUS_H_
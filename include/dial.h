@@ -46,11 +46,19 @@
     #include <wx/wx.h>
 #endif
 
+#include <wx/geometry.h>
+
 #include "instrument.h"
 
 // 0 degrees are at 12 o´clock
 #define ANGLE_OFFSET 90
 
+// Markers or labels around a dial, more than this are not drawn
+#define DIAL_MAX_MARKERS 360
+
+// Points of the needle outline, as drawn by DrawForeground()
+#define DIAL_NEEDLE_POINTS 4
+
 typedef enum {
 	DIAL_LABEL_NONE,
 	DIAL_LABEL_HORIZONTAL,
@@ -80,6 +88,12 @@ typedef enum {
 extern double rad2deg(double angle);
 extern double deg2rad(double angle);
 
+// A marker or label position on the dial, the angle is in degrees from 3 o'clock
+typedef struct {
+	double Angle;
+	double Cos, Sin;
+} DialDirection;
+
 //+------------------------------------------------------------------------------
 //|
 //| CLASS:
@@ -95,7 +109,8 @@ public:
 	~OdometerInstrument_Dial(void);
 
 	wxSize GetSize(int orient, wxSize hint);
-	void SetData(int, double, wxString);
+	void SetData(int, double, const wxString &);
+	void SetColorScheme(PI_ColorScheme cs);
 	void SetOptionMarker(double step, DialMarkerOption option, int offset);
 	void SetOptionLabel(double step, DialLabelOption option, wxArrayString labels = wxArrayString()); // { m_LabelStep = step; m_LabelOption = option; m_LabelArray = labels; }
 	void SetOptionMainValue(wxString format, DialPositionOption option);
@@ -122,8 +137,27 @@ protected:
 	double m_MarkerStep, m_LabelStep;
 	DialLabelOption m_LabelOption;
 	wxArrayString m_LabelArray;
+
+	// Labels, frame, markers and background pre-rendered, with what they were drawn for
+	wxBitmap m_StaticLayer;
+	wxSize m_StaticSize;
+	int m_StaticTitleHeight;
+	wxFont m_StaticFont;
+	double m_StaticMin, m_StaticMax;
+
+	// Marker and label directions and the needle outline for a unit radius,
+	// they only depend on the angles, the range and the steps
+	bool m_bGeometryValid;
+	DialDirection m_MarkerDir[DIAL_MAX_MARKERS];
+	int m_MarkerCount;
+	DialDirection m_LabelDir[DIAL_MAX_MARKERS];
+	int m_LabelCount;
+	wxPoint2DDouble m_Needle[DIAL_NEEDLE_POINTS];
 	
 	virtual void Draw(wxGCDC* dc);
+	void RenderStaticLayer(const wxSize &size);
+	void UpdateGeometry();
+	static int BuildDirections(DialDirection *dir, int start, int range, double step, double span);
 	virtual void DrawFrame(wxGCDC* dc);
 	virtual void DrawMarkers(wxGCDC* dc);
 	virtual void DrawLabels(wxGCDC* dc);
@@ -0,0 +1,51 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _GEODESY_H_
+#define _GEODESY_H_
+
+// Distances between two positions in signed decimal degrees (North and East
+// positive), all results are in nautical miles.
+
+// Mean earth radius, as used for the nautical mile
+#define EARTH_RADIUS_NM 3440.065
+#define METERS_PER_NM 1852.0
+
+// Flat earth approximation, accurate to a few cm for legs below ~1 NM
+double EquirectangularDistance(double lat1, double lon1, double lat2, double lon2);
+
+// Great circle on a sphere, well conditioned for short and long legs
+double HaversineDistance(double lat1, double lon1, double lat2, double lon2);
+
+// Geodesic on the WGS84 ellipsoid. Falls back to the haversine result for
+// nearly antipodal points where the iteration does not converge.
+double VincentyDistance(double lat1, double lon1, double lat2, double lon2);
+
+// Picks equirectangular for the short steps between consecutive fixes and
+// haversine otherwise, or Vincenty when the ellipsoid is requested.
+double GeodesicDistance(double lat1, double lon1, double lat2, double lon2, bool ellipsoid);
+
+#endif // _GEODESY_H_
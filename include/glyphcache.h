@@ -0,0 +1,90 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _GLYPHCACHE_H_
+#define _GLYPHCACHE_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/dcgraph.h>
+#include <wx/graphics.h>
+
+// Printable ASCII is cached, which covers the digits, units, dates and
+// punctuation of the readouts
+#define GLYPH_FIRST ' '
+#define GLYPH_LAST  '~'
+#define GLYPH_COUNT (GLYPH_LAST - GLYPH_FIRST + 1)
+
+//
+// CLASS:
+//    OdometerGlyphCache
+//
+// DESCRIPTION:
+//    Pre-rasterized glyphs of one font, drawn on the instrument background
+//    colour with a plain memory DC at the content scale factor of the
+//    display and converted once to graphics bitmaps of the renderer the
+//    instruments paint with. A readout is composed by drawing one of them
+//    per character at its advance width, so a paint does no text layout,
+//    rasterization or bitmap conversion. The glyphs are drawn again when the
+//    font, the colour scheme or the scale factor changes. Text with a
+//    character outside the cache, and any text in a font whose ink spills
+//    past its advance or whose advances are not whole pixels, is left to the
+//    caller.
+//
+class OdometerGlyphCache {
+public:
+	OdometerGlyphCache();
+
+	bool DrawText(wxGCDC *dc, const wxFont &font, const wxColour &fore, const wxColour &back,
+		const wxString &text, wxCoord x, wxCoord y);
+
+private:
+	void Build(const wxFont &font, const wxColour &fore, const wxColour &back, double scale);
+	void Convert(wxGraphicsContext *gc);
+	bool InkFits(wxScreenDC &sdc, const wxFont &font);
+
+	bool m_bValid;
+	// False when the font cannot be composed from the glyphs without change
+	bool m_bFits;
+	wxFont m_Font;
+	wxColour m_Fore;
+	wxColour m_Back;
+	double m_Scale;
+	wxBitmap m_Glyphs[GLYPH_COUNT];
+	// Logical size, the bitmaps have m_Scale times as many pixels
+	int m_Advance[GLYPH_COUNT];
+	int m_Height;
+
+	// m_Glyphs as created by m_pRenderer, NULL until converted
+	wxGraphicsRenderer *m_pRenderer;
+	wxGraphicsBitmap m_GraphicsGlyphs[GLYPH_COUNT];
+};
+
+#endif // _GLYPHCACHE_H_
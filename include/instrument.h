@@ -47,6 +47,10 @@
 #include <wx/dcbuffer.h>
 #include <wx/dcgraph.h>         // supplemental, for Mac
 
+#include "channelbus.h"
+#include "glyphcache.h"
+#include "valueformat.h"
+
 // This is the degree sign in UTF8. It should be correctly handled on both Win & Unix
 const wxString DEGREE_SIGN = wxString::Format(_T("%c"), 0x00B0); 
 
@@ -56,6 +60,7 @@ extern wxFont *g_pFontTitle;
 extern wxFont *g_pFontData;
 extern wxFont *g_pFontLabel;
 extern wxFont *g_pFontSmall;
+extern OdometerGlyphCache *g_pGlyphsData;
 
 wxString toSDMM(int NEflag, double a);
 
@@ -74,8 +79,13 @@ enum {
     OCPN_DBP_STC_LEGTIME    = 1 << 7,
     OCPN_DBP_STC_STARTSTOP  = 1 << 8,  // Number referenced in button module, do not change!
     OCPN_DBP_STC_LEGRES     = 1 << 9,  // Number referenced in button module, do not change!
+    // New channels go here, with ODOMETER_CHANNEL_COUNT raised to match
 };
 
+// The channel bus, the instruments and the profiler size their tables by it
+static_assert(OCPN_DBP_STC_LEGRES == 1 << (ODOMETER_CHANNEL_COUNT - 1),
+    "ODOMETER_CHANNEL_COUNT does not match the OCPN_DBP_STC_ channels");
+
 
 class OdometerInstrument : public wxControl {
 public:
@@ -86,7 +96,10 @@ public:
 	void OnEraseBackground(wxEraseEvent &WXUNUSED(evt));
 	virtual wxSize GetSize(int orient, wxSize hint) = 0;
 	void OnPaint(wxPaintEvent &WXUNUSED(event));
-	virtual void SetData(int st, double data, wxString unit) = 0;
+	virtual void SetData(int st, double data, const wxString &unit) = 0;
+	// Drops whatever was pre-rendered in the colors of the previous scheme
+	virtual void SetColorScheme(PI_ColorScheme cs) {}
+	bool PullChannels(const OdometerChannelBus &bus);
 	void SetDrawSoloInPane(bool value);
 	void MouseEvent(wxMouseEvent &event);
       
@@ -97,10 +110,16 @@ protected:
 	int m_cap_flag;
 	int m_TitleHeight;
 	wxString m_title;
+	// Set by SetData() when what is drawn has changed, cleared by PullChannels()
+	bool m_bDamaged;
 	virtual void Draw(wxGCDC *dc) = 0;
+	void DrawDataText(wxGCDC *dc, const wxString &text, int height);
 
 private:
 	bool m_drawSoloInPane;
+	// What was taken from the channel bus so far
+	unsigned long m_BusSequence;
+	unsigned long m_ChannelVersion[ODOMETER_CHANNEL_COUNT];
 };
 
 class OdometerInstrument_Single : public OdometerInstrument {
@@ -109,12 +128,20 @@ public:
 	~OdometerInstrument_Single(){}
 
 	wxSize GetSize(int orient, wxSize hint);
-	void SetData(int st, double data, wxString unit);
+	void SetData(int st, double data, const wxString &unit);
 
 protected:
 	wxString m_data;
 	wxString m_format;
 	int m_DataHeight;
+	// Fast path for m_format, and what the current m_data was made from
+	OdometerValueFormat m_ValueFormat;
+	bool m_bHaveUnit;
+	wxString m_unit;
+	wxString m_prefix;
+	wxString m_suffix;
+	bool m_bHaveValue;
+	long long m_Scaled;
 	
 	void Draw(wxGCDC *dc);
 };
@@ -125,7 +152,7 @@ public:
 	~OdometerInstrument_String(){}
 
 	wxSize GetSize(int orient, wxSize hint);
-	void SetData(int st, double data, wxString unit);
+	void SetData(int st, double data, const wxString &unit);
 
 protected:
 	wxString m_data;
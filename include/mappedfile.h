@@ -0,0 +1,80 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#ifdef __WXMSW__
+#include <windows.h>
+#endif
+
+//
+// CLASS:
+//    MappedFile
+//
+// DESCRIPTION:
+//    Read/write memory mapping of a whole file. The file is created when
+//    missing and extended with zeros to the requested size. OpenReadOnly()
+//    maps an existing file for a sequential scan instead.
+//
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const wxString &path, size_t minimumSize);
+	bool OpenReadOnly(const wxString &path);
+	bool Resize(size_t size);
+	void Sync();
+	void Close();
+
+	bool IsOpened() const { return m_pData != NULL; }
+	void *Data() const { return m_pData; }
+	size_t Size() const { return m_Size; }
+
+private:
+	bool OpenFile(const wxString &path, bool readOnly, size_t *size);
+	bool Map(size_t size);
+	void Unmap();
+
+#ifdef __WXMSW__
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+#else
+	int m_fd;
+#endif
+	void *m_pData;
+	size_t m_Size;
+	bool m_bReadOnly;
+};
+
+#endif // _MAPPEDFILE_H_
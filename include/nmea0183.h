@@ -51,6 +51,8 @@
 #include "wx/list.h"
 #include "wx/arrstr.h"
 
+#include <string>
+
 /*
 ** Turn off the warning about precompiled headers, it is rather annoying
 */
@@ -139,6 +141,13 @@ typedef enum _transducertype
    GenericTransducer			 = 'G'
 } TRANSDUCER_TYPE;
 
+typedef enum _nmea0183_field_status
+{
+   FieldValid = 0,
+   FieldEmpty,
+   FieldMalformed
+} NMEA0183_FIELD_STATUS;
+
 typedef enum
 {
       RouteUnknown = 0,
@@ -151,6 +160,11 @@ typedef enum
 */
 
 int HexValue( const wxString& hex_string );
+long ChecksumValue( const char *field, size_t length );
+NMEA0183_FIELD_STATUS DecimalValue( const char *field, size_t length, double *value );
+NMEA0183_FIELD_STATUS IntegerValue( const char *field, size_t length, int *value );
+NMEA0183_FIELD_STATUS TimeOfDayValue( const char *field, size_t length, double *seconds );
+NMEA0183_FIELD_STATUS DateValue( const char *field, size_t length, long *days );
 
 wxString& expand_talker_id( const wxString & );
 wxString& Hex( int value );
@@ -58,6 +58,28 @@
 
 WX_DECLARE_LIST(RESPONSE, MRL);
 
+/*
+** Sentence identifiers are the three mnemonic characters packed into an
+** integer, proprietary sentences all share the identifier of "P"
+*/
+
+#define NMEA0183_SENTENCE_ID( a, b, c ) \
+   ( ( (unsigned int)(unsigned char)(a) << 16 ) | ( (unsigned int)(unsigned char)(b) << 8 ) | (unsigned int)(unsigned char)(c) )
+
+#define NMEA0183_ID_UNKNOWN     0
+#define NMEA0183_ID_PROPRIETARY NMEA0183_SENTENCE_ID( 'P', 0, 0 )
+#define NMEA0183_ID_GGA         NMEA0183_SENTENCE_ID( 'G', 'G', 'A' )
+#define NMEA0183_ID_RMC         NMEA0183_SENTENCE_ID( 'R', 'M', 'C' )
+
+// Must be a power of two
+#define NMEA0183_DISPATCH_TABLE_SIZE 32
+
+inline unsigned int NMEA0183_DISPATCH_SLOT( unsigned int sentence_id )
+{
+   // Multiplicative hash, collision free for the sentences in the response table
+   return( ( sentence_id * 0x9E3779B1u ) >> 27 ) & ( NMEA0183_DISPATCH_TABLE_SIZE - 1 );
+}
+
 class NMEA0183
 {
 
@@ -71,8 +93,17 @@ class NMEA0183
 
       MRL response_table;
 
+      // Response lookup by sentence identifier, built from response_table
+      unsigned int dispatch_ids[ NMEA0183_DISPATCH_TABLE_SIZE ];
+      RESPONSE    *dispatch_table[ NMEA0183_DISPATCH_TABLE_SIZE ];
+
+      // PreParse() result for the current sentence, Parse() reuses it
+      int preparse_state;
+
       void set_container_pointers( void);
       void sort_response_table( void);
+      void build_dispatch_table( void);
+      RESPONSE *find_response( unsigned int sentence_id) const;
 
    public:
 
@@ -89,6 +120,7 @@ class NMEA0183
       wxString ErrorMessage; // Filled when Parse returns FALSE
       wxString LastSentenceIDParsed; // ID of the lst sentence successfully parsed
       wxString LastSentenceIDReceived; // ID of the last sentence received, may not have parsed successfully
+      unsigned int LastSentenceIDCode; // Packed NMEA0183_SENTENCE_ID of LastSentenceIDReceived
 
       wxString TalkerID;
       wxString ExpandedTalkerID;
@@ -96,6 +128,7 @@ class NMEA0183
 //      MANUFACTURER_LIST Manufacturers;
 
       bool IsGood( void) const;
+      bool IsChecksumBad( void) const;
       bool Parse( void);
       bool PreParse( void);
 
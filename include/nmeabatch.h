@@ -0,0 +1,97 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _NMEABATCH_H_
+#define _NMEABATCH_H_
+
+#include <cstddef>
+
+// A GGA as used by the odometer, decoded as GGA::Parse() does
+struct NmeaGGARecord {
+	char   Talker[3];
+	int    SatsInUse;           // 0 if missing
+	double HDOPlevel;           // 99.99 if missing
+};
+
+// An RMC as used by the odometer, decoded as RMC::Parse() does
+struct NmeaRMCRecord {
+	char   Talker[3];
+	bool   DataValid;           // Status A, a usable speed and not a 2.3 mode N or S
+	double SecondsOfDay;        // UTC, -1 if unknown
+	long   DayNumber;           // Days since 1970, -1 if unknown
+	double Speed;               // Knots, 0 if missing
+	bool   HavePosition;
+	double Latitude;            // Signed decimal degrees, North positive
+	double Longitude;           // Signed decimal degrees, East positive
+};
+
+// Receives the decoded sentences in the order they appear in the log
+class NmeaBatchSink {
+public:
+	virtual ~NmeaBatchSink() {}
+	virtual void OnGGA(const NmeaGGARecord &gga) = 0;
+	virtual void OnRMC(const NmeaRMCRecord &rmc) = 0;
+};
+
+struct NmeaBatchStats {
+	unsigned long Lines;
+	unsigned long GGA;            // Decoded and passed to the sink
+	unsigned long RMC;
+	unsigned long BadChecksums;
+	unsigned long TooLong;        // Would not have fitted a ring slot on the live path
+	unsigned long Skipped;        // Other sentences, AIS, proprietary and non NMEA lines
+};
+
+// NMEA ddmm.mmmm to signed decimal degrees
+double NmeaDegrees(double ddmm, bool negative);
+
+//
+// CLASS:
+//    NmeaBatchDecoder
+//
+// DESCRIPTION:
+//    Decodes the GGA and RMC sentences of a whole log held in memory, usually
+//    a memory mapped file, without SENTENCE or wxString. Line ends and
+//    sentence starts are found with memchr(), other sentences are skipped
+//    from their address field alone, and the checksum is verified in the
+//    same pass that splits the fields, before any field is converted.
+//    Accepts and decodes exactly what the live path does for the same lines.
+//
+class NmeaBatchDecoder {
+public:
+	NmeaBatchDecoder(NmeaBatchSink *sink);
+
+	void Decode(const char *data, size_t size);
+	const NmeaBatchStats &GetStats() const { return m_Stats; }
+
+private:
+	void DecodeLine(const char *line, const char *end);
+
+	NmeaBatchSink *m_pSink;
+	NmeaBatchStats m_Stats;
+};
+
+#endif // _NMEABATCH_H_
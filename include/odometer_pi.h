@@ -49,8 +49,12 @@
 // Differs from the built-in plugins, so that we can build outside of OpenCPN source tree
 #include "ocpn_plugin.h"
 
-// NMEA0183 Sentence parsing functions
-#include "nmea0183.h"
+// NMEA0183 Sentence parsing and distance integration thread
+#include "odometerworker.h"
+// Trip, leg, departure and arrival logic
+#include "odometerengine.h"
+// Latency histograms, compiled in with ODOMETER_PROFILE
+#include "odometerprofile.h"
 
 // Odometer instruments/dials/gauges
 #include "instrument.h"
@@ -65,10 +69,6 @@ class OdometerInstrumentContainer;
 // Request default positioning of toolbar tool
 #define ODOMETER_TOOL_POSITION -1          
 
-// If no data received in 5 seconds, zero the instrument displays
-// #define WATCHDOG_TIMEOUT_COUNT  5
-#define gps_watchdog_timeout_ticks  5
-
 class OdometerWindowContainer {
 public:
 	OdometerWindowContainer(OdometerWindow *odometer_window, wxString name, wxString caption, wxString orientation, wxArrayInt inst) {
@@ -114,6 +114,12 @@ WX_DEFINE_ARRAY(OdometerInstrumentContainer *, wxArrayOfInstrument);
 #endif
 
 
+// Local time as configured by the UTC offset preference, in wxDateTime milliseconds
+class OdometerLocalClock : public OdometerClock {
+public:
+	OdometerTime Now();
+};
+
 //
 // Odometer PlugIn Class Definition
 //
@@ -153,13 +159,12 @@ public:
 	void ShowOdometer(size_t id, bool visible);
 	int GetToolbarItemId();
 	int GetOdometerWindowShownCount();
-    void Odometer();
+    void Odometer(bool newFix);
 
 	  
     int id;
     wxString dt;
 
-    double TotDist = 0.0;
     wxString DistUnit;
 //	wxAuiManager *m_pauimgr;
 
@@ -173,9 +178,9 @@ private:
     void LoadFont(wxFont **target, wxString native_info);
 
 	void ApplyConfig(void);
-	// Send deconstructed NMEA 1083 sentence  values to each display
-	void SendSentenceToAllInstruments(int st, double value, wxString unit);
-	void GetDistance();
+	void UpdateDistanceUnit();
+	void UpdateChannels();
+	void PublishDirtyChannels();
 
 	// OpenCPN goodness, pointers to Configuration, AUI Manager and Toolbar
 	wxFileConfig *m_pconfig;
@@ -187,71 +192,45 @@ private:
 	int m_show_id;
 	int m_hide_id;
 
-	// Used to parse NMEA Sentences
-	NMEA0183 m_NMEA0183;
-    short mPriCOGSOG;
-    short mPriDateTime;
-    wxDateTime mUTCDateTime;
-    iirfilter mSOGFilter;
+	// NMEA Sentences are parsed and integrated by the worker thread
+	OdometerWorker *m_pWorker;
+	OdometerSnapshot m_Snapshot;
+	unsigned long m_LastFixSequence;
+	double m_LastDistance;
+	bool m_bSOGValid;
+	// OCPN_DBP_STC_ channels whose value changed since they were last published
+	int m_DirtyChannels;
+	// Latest value of every channel, pulled by the instruments
+	OdometerChannelBus m_Bus;
+
+	// The odometer itself, the plugin only adapts it to the instruments and configuration
+	OdometerLocalClock m_Clock;
+	OdometerEngine *m_pEngine;
     wxString m_SatsInUse;
     wxString m_PwrOnDelSecs;
     wxString m_HDOPdefine;
-    int SatsInUse;
-    double HDOPlevel;
-    int validGPS = 0;
-    int StartDelay = 1;
-    int mRMC_Watchdog;
-    int mGGA_Watchdog;
-
-    // Odometer time
-    wxDateTime UTCTime;
-    wxTimeSpan TimeOffset;
-    wxDateTime LocalTime;
-
-    // Odometer trip time
-    double CurrSpeed; 
-    double FilteredSpeed; 
-    double m_OnRouteSpeed;
-    wxDateTime EnabledTime;
-    wxDateTime DepTime;
-    wxDateTime ArrTime;
-    int ArrTimeShow = 1;
+
+    // Instrument strings, only rebuilt when the engine reports a change
     wxString strDep;
     wxString strArr;
-    int SetDepTime = 0;
-    int UseSavedDepTime = 1;
-    int UseSavedArrTime = 1;
+    wxString strLegTime;
 
-    // Odometer Trip and Sumlog distances
+    // Saved Trip and Sumlog distances, departure and arrival times
     wxString m_TotDist;
     wxString m_TripDist;
     wxString m_DepTime; 
     wxString m_ArrTime;
-    double StepDist = 0;
-    double TripDist = 0;
-    int ResetDist;
-    int CurrSec;
-    int PrevSec;
-    int SecDiff;
-    int UseSavedTrip = 1; 
     double DistDiv = 3600;
 
-    // Odometer leg distance and time 
-    int DepTimeShow = 1;
-    wxString m_LegDist;
-    wxString m_LegTime; 
-    double LegDist = 0;
-    int CountLeg = 0;
-    wxDateTime LegStart;
-    wxTimeSpan LegTime;
-
 	// Odometer uses version 2 configuration settings
 	int m_config_version;
 };
 
 class OdometerPreferencesDialog : public wxDialog {
 public:
-	OdometerPreferencesDialog(wxWindow *pparent, wxWindowID id, wxArrayOfOdometer config);
+	OdometerPreferencesDialog(wxWindow *pparent, wxWindowID id, wxArrayOfOdometer config,
+		const TripHistorySummary *history, const OdometerSentenceStats *sentenceStats,
+		double distDiv, const wxString &distUnit);
 	~OdometerPreferencesDialog() {}
 
 	void OnCloseDialog(wxCloseEvent& event);
@@ -259,6 +238,9 @@ public:
 	void OnInstrumentSelected(wxListEvent& event);
 	void SaveOdometerConfig(void);
     void RecalculateSize( void );
+#ifdef ODOMETER_PROFILE
+	void OnSaveDiagnostics(wxCommandEvent& event);
+#endif
 
 	wxArrayOfOdometer m_Config;
 	wxFontPickerCtrl *m_pFontPickerTitle;
@@ -268,9 +250,13 @@ public:
 	wxSpinCtrl *m_pSpinSpeedMax;
     wxSpinCtrl *m_pSpinCOGDamp;
     wxSpinCtrl *m_pSpinOnRoute;
+    wxSpinCtrl *m_pSpinDisplayFPS;
+    wxSpinCtrl *m_pSpinWatchdogPeriods;
     wxChoice *m_pChoiceUTCOffset;
     wxChoice *m_pChoiceSpeedUnit;
     wxChoice *m_pChoiceDistanceUnit;
+    wxChoice *m_pChoiceDistanceEngine;
+    wxCheckBox *m_pCheckBoxEllipsoid;
     wxSpinCtrlDouble *m_pSpinDBTOffset;
 	wxCheckBox *m_pCheckBoxShowSpeed;
 	wxCheckBox *m_pCheckBoxShowDepArrTimes;
@@ -337,7 +323,7 @@ public:
     void OnContextMenuSelect(wxCommandEvent& evt);
     bool isInstrumentListEqual(const wxArrayInt& list);
     void SetInstrumentList(wxArrayInt list);
-    void SendSentenceToAllInstruments(int st, double value, wxString unit);
+    void PullChannels(const OdometerChannelBus &bus);
     void ChangePaneOrientation(int orient, bool updateAUImgr);
 
 	// TODO: OnKeyPress pass event to main window or disable focus
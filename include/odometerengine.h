@@ -0,0 +1,113 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _ODOMETERENGINE_H_
+#define _ODOMETERENGINE_H_
+
+// Milliseconds in the time base of the clock, -1 when a time is not set
+typedef long long OdometerTime;
+#define ODOMETER_NO_TIME -1LL
+
+// Source of the current time, injected so the engine can be replayed and tested
+class OdometerClock {
+public:
+	virtual ~OdometerClock() {}
+	virtual OdometerTime Now() = 0;
+};
+
+// A new GPS fix as seen by the engine
+struct OdometerEngineFix {
+	double Speed;               // Knots
+	double Distance;            // Nautical miles travelled since the previous fix
+};
+
+// Parts of OdometerEngineState that changed, as returned by TakeChanges()
+enum {
+	ODOMETER_CHANGED_TOTAL     = 1 << 0,
+	ODOMETER_CHANGED_TRIP      = 1 << 1,
+	ODOMETER_CHANGED_DEPARTURE = 1 << 2,
+	ODOMETER_CHANGED_ARRIVAL   = 1 << 3,
+	ODOMETER_CHANGED_LEG_DIST  = 1 << 4,
+	ODOMETER_CHANGED_LEG_TIME  = 1 << 5,
+	ODOMETER_CHANGED_ALL       = (1 << 6) - 1
+};
+
+struct OdometerEngineState {
+	double TotalDistance;       // Nautical miles
+	double TripDistance;
+	double LegDistance;
+	OdometerTime DepartureTime; // Start of the trip, set at the first speed above the on route speed
+	OdometerTime ArrivalTime;   // Set when the speed drops below the on route speed again
+	bool OnRoute;               // Departed and still above the on route speed
+	bool LegRunning;
+	OdometerTime LegTime;       // Time counted on the leg, excluding pauses
+};
+
+//
+// CLASS:
+//    OdometerEngine
+//
+// DESCRIPTION:
+//    Trip, leg, departure and arrival logic of the odometer. Takes typed
+//    fix events and commands, keeps distances in nautical miles and times
+//    from the injected clock, and does no formatting, so it has no GUI or
+//    wxWidgets dependencies. The plugin converts units and builds the
+//    instrument strings only for the parts reported by TakeChanges().
+//
+class OdometerEngine {
+public:
+	OdometerEngine(OdometerClock *clock);
+
+	// Settings
+	void SetOnRouteSpeed(double knots);
+	void SetLegEnabled(bool enabled);
+
+	// Continue from saved distances and times, ODOMETER_NO_TIME if not set
+	void Restore(double total, double trip, OdometerTime departure, OdometerTime arrival);
+
+	// Events
+	void OnFix(const OdometerEngineFix &fix);
+	void Tick();
+	void ResetTrip();
+	void ResetLeg();
+	void StartStopLeg();
+
+	const OdometerEngineState &GetState() const { return m_State; }
+	// Returns the ODOMETER_CHANGED_ flags gathered since the previous call
+	int TakeChanges();
+
+private:
+	void UpdateLegTime(OdometerTime now);
+
+	OdometerClock *m_Clock;
+	OdometerEngineState m_State;
+	int m_Changes;
+	double m_OnRouteSpeed;
+	bool m_bLegEnabled;
+	OdometerTime m_LegStart;    // Clock time the running leg would have started without pauses
+};
+
+#endif // _ODOMETERENGINE_H_
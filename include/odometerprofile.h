@@ -0,0 +1,125 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _ODOMETERPROFILE_H_
+#define _ODOMETERPROFILE_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <atomic>
+#include <chrono>
+
+#include "channelbus.h"
+
+// Stages timed when built with ODOMETER_PROFILE
+enum {
+	PROFILE_PREPARSE,           // NMEA0183::PreParse() of every queued sentence
+	PROFILE_PARSE_GGA,          // Parse() and hand-over of a GGA
+	PROFILE_PARSE_RMC,          // Parse() and hand-over of an RMC, including the distance step
+	PROFILE_DISTANCE,           // OdometerWorker::IntegrateFix()
+	PROFILE_ODOMETER,           // odometer_pi::Odometer()
+	PROFILE_FANOUT,             // Channels pulled by the instruments
+	PROFILE_DRAW,               // One stage per instrument, by OCPN_DBP_STC_ bit
+	PROFILE_STAGES = PROFILE_DRAW + ODOMETER_CHANNEL_COUNT
+};
+
+// Log-linear buckets, 8 per power of two, up to about 2^40 ns
+#define PROFILE_SUB_BUCKETS 8
+#define PROFILE_BUCKETS 304
+
+struct OdometerProfileStats {
+	unsigned long Count;
+	double Mean;                // Microseconds, as are the values below
+	double Min;
+	double Max;
+	double P50;                 // Percentiles are the upper edge of their bucket,
+	double P90;                 // within 12.5 % of the true value
+	double P99;
+	double P999;
+};
+
+//
+// CLASS:
+//    OdometerProfile
+//
+// DESCRIPTION:
+//    Latency histograms of the parser, the odometer and the instruments, in
+//    the manner of HdrHistogram: a sample costs two clock reads and three
+//    counter updates, without locks or allocation. Each stage is recorded by
+//    a single thread, any thread may read them. Only compiled in with
+//    ODOMETER_PROFILE, otherwise ODOMETER_PROFILE_SCOPE expands to nothing.
+//
+class OdometerProfile {
+public:
+	static OdometerProfile &Get();
+
+	void Record(int stage, unsigned long long ns);
+	bool GetStats(int stage, OdometerProfileStats *stats) const;
+	static const char *StageName(int stage);
+	wxString Report() const;
+	bool Dump(const wxString &path) const;
+
+private:
+	OdometerProfile();
+	static int Bucket(unsigned long long ns);
+	static unsigned long long BucketLimit(int bucket);
+
+	struct Histogram {
+		std::atomic<unsigned long> Count;
+		std::atomic<unsigned long long> Total;
+		std::atomic<unsigned long long> Min;
+		std::atomic<unsigned long long> Max;
+		std::atomic<unsigned long> Buckets[PROFILE_BUCKETS];
+	};
+	Histogram m_Stages[PROFILE_STAGES];
+};
+
+// Times the rest of the enclosing block as one sample of a stage
+class OdometerProfileScope {
+public:
+	OdometerProfileScope(int stage) : m_Stage(stage), m_Start(std::chrono::steady_clock::now()) {}
+	~OdometerProfileScope() {
+		std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - m_Start;
+		OdometerProfile::Get().Record(m_Stage,
+			(unsigned long long) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	}
+
+private:
+	int m_Stage;
+	std::chrono::steady_clock::time_point m_Start;
+};
+
+#ifdef ODOMETER_PROFILE
+#define ODOMETER_PROFILE_SCOPE(stage) OdometerProfileScope odometerProfileScope(stage)
+#else
+#define ODOMETER_PROFILE_SCOPE(stage)
+#endif
+
+#endif // _ODOMETERPROFILE_H_
@@ -0,0 +1,243 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _ODOMETERWORKER_H_
+#define _ODOMETERWORKER_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/thread.h>
+#include <atomic>
+
+// NMEA0183 Sentence parsing functions
+#include "nmea0183.h"
+#include "iirfilter.h"
+#include "sentencering.h"
+#include "triplog.h"
+#include "nmeabatch.h"
+#include "sentencestats.h"
+
+// If no data received in 5 seconds, zero the instrument displays. Also the
+// longest a fix is trusted once the update rate of its source is known.
+#define gps_watchdog_timeout_ticks  5
+
+// A fix is stale after this many update periods of its source without one
+#define WATCHDOG_DEFAULT_PERIODS 3
+#define WATCHDOG_MINIMUM_PERIODS 2
+#define WATCHDOG_MAXIMUM_PERIODS 10
+
+// How the travelled distance is measured
+enum {
+	DISTANCE_ENGINE_SOG,        // Speed over ground integrated over the fix times
+	DISTANCE_ENGINE_POSITION,   // Geodesic distance between fix positions
+	DISTANCE_ENGINE_COMBINED    // Speed while moving, position when stationary or across gaps
+};
+
+// Number of GNSS sources (talkers) tracked at the same time
+#define ODOMETER_MAX_SOURCES 4
+
+// Update rate of one sentence type from one source, learned as it arrives
+struct OdometerCadence {
+	wxLongLong_t LastArrival;   // Local clock ms, -1 if never received
+	double Period;              // Average interval in ms, 0 until measured
+	int    Outliers;            // Intervals in a row that were well over the period
+};
+
+// A GNSS receiver as told apart by its talker ID (GP, GN, GL, ...)
+struct OdometerSource {
+	char   Talker[3];
+	bool   HaveGGA;             // SatsInUse/HDOP below come from its own GGA
+	int    SatsInUse;
+	double HDOPlevel;
+	double Quality;             // Rolling score, 0 worst to 1 best
+	bool   Valid;               // Last RMC passed the gates
+	wxLongLong_t LastFixTime;   // UTC ms of the last RMC, -1 if unknown
+	unsigned long Fixes;
+	OdometerCadence RMC;        // By arrival on the local clock, for the watchdogs
+	OdometerCadence GGA;
+	OdometerCadence Fix;        // By RMC fix time, for failover and integration gaps
+};
+
+// One accepted RMC fix, as used by the distance integration
+struct OdometerFix {
+	double SecondsOfDay;        // UTC, -1 if unknown
+	long   DayNumber;           // Days since 1970, -1 if unknown
+	double Speed;               // Knots
+	bool   HavePosition;
+	double Latitude;            // Signed decimal degrees, North positive
+	double Longitude;           // Signed decimal degrees, East positive
+};
+
+// Odometer state published by the worker, copied as a whole by the UI
+struct OdometerSnapshot {
+	unsigned long Sequence;     // Incremented for every published snapshot
+	unsigned long FixSequence;  // Incremented for every accepted RMC fix
+	bool   ValidGPS;            // Last RMC fix passed the SatsInUse/HDOP gates
+	bool   SpeedValid;          // False once the RMC watchdog has expired
+	double CurrSpeed;           // Knots, as received
+	double FilteredSpeed;       // Knots, for the speedometer
+	double Distance;            // Nautical miles integrated since start
+	wxLongLong_t FixTime;       // UTC milliseconds since 1970 of the last fix, -1 if unknown
+	int    SatsInUse;
+	double HDOPlevel;
+	unsigned long DuplicateFixes;  // Same fix time as the previous fix, ignored
+	unsigned long FixGaps;         // Time gaps or steps back, not integrated across
+	unsigned long PositionJumps;   // Implausible position steps, not counted
+	char   Source[3];              // Talker ID of the source being integrated
+	unsigned long SourceSwitches;  // Changes of the integrated source
+	unsigned long SecondaryFixes;  // Fixes from the other sources, not integrated
+};
+
+// Sentences dropped by the prefilter in Submit(), counted per category
+enum {
+	REJECT_AIS,            // !xxVDM/!xxVDO and other encapsulated sentences
+	REJECT_PROPRIETARY,    // $Pxxx
+	REJECT_NOT_NMEA,       // No $ or no address field
+	REJECT_UNCONSUMED,     // Valid NMEA, but a sentence the odometer does not use
+	REJECT_TOO_LONG,       // Does not fit a ring slot
+	REJECT_OVERRUN,        // Ring full, the worker is behind
+	REJECT_CATEGORIES
+};
+
+struct OdometerFilterStats {
+	unsigned long Accepted;
+	unsigned long Rejected[REJECT_CATEGORIES];
+};
+
+//
+// CLASS:
+//    OdometerWorker
+//
+// DESCRIPTION:
+//    Parses NMEA sentences and integrates distance away from the GUI thread.
+//    OpenCPN's main thread queues raw sentences with Submit(), the worker owns
+//    the parser, the speed filter and the distance integrator and publishes
+//    an OdometerSnapshot that the plugin reads on its timer tick. Recorded
+//    logs can be imported in bulk through the batch decoder instead.
+//
+class OdometerWorker : public wxThread, private NmeaBatchSink {
+public:
+	OdometerWorker();
+	~OdometerWorker();
+
+	// GUI thread interface
+	bool Submit(const wxString &sentence);
+	void SetGates(int satsInUse, int hdop, int pwrOnDelaySecs);
+	void SetDistanceEngine(int engine, bool ellipsoid);
+	void SetSpeedFilter(double fc);
+	void SetWatchdogPeriods(int periods);
+	bool OpenJournal(const wxString &path, double *total, double *trip);
+	bool ImportLog(const wxString &path, NmeaBatchStats *stats);
+	void ResetTrip();
+	bool GetHistory(TripHistorySummary *summary);
+	OdometerSnapshot GetSnapshot();
+	void GetSentenceStats(OdometerSentenceStats *stats);
+	OdometerFilterStats GetFilterStats() const;
+	void Stop();
+
+	// Replay interface, only while the thread is not running
+	unsigned int ProcessQueued();
+
+protected:
+	ExitCode Entry();
+
+private:
+	static bool IsConsumedSentence(unsigned int id);
+	int Prefilter(const wxString &sentence) const;
+	unsigned int Drain();
+	void ProcessSentence(const RawSentence &raw);
+	void OnGGA(const NmeaGGARecord &gga);
+	void OnRMC(const NmeaRMCRecord &rmc);
+	OdometerSource *FindSource(const char *talker);
+	bool SelectSource(OdometerSource *source, wxLongLong_t fixTime);
+	OdometerSource *BestSource(wxLongLong_t fixTime, const OdometerSource *exclude);
+	wxLongLong_t FailoverAfter(const OdometerSource *source) const;
+	void IntegrateFix(const OdometerFix &fix);
+	double PositionStep(const OdometerFix &fix, double interval);
+	void LearnCadence(OdometerCadence *cadence, wxLongLong_t now);
+	wxLongLong_t StaleAfter(const OdometerCadence &cadence) const;
+	bool CheckWatchdogs();
+	void Publish();
+
+	SentenceRing<RawSentence, SENTENCE_RING_SIZE> m_Ring;
+	wxSemaphore m_Wakeup;
+	std::atomic<bool> m_bStop;
+	// Only written by the producer, may be read from any thread
+	std::atomic<unsigned long> m_Accepted;
+	std::atomic<unsigned long> m_Rejected[REJECT_CATEGORIES];
+
+	// Gates configured from the preferences
+	std::atomic<int> m_SatsRequired;
+	std::atomic<int> m_HDOPLimit;
+	std::atomic<int> m_PwrOnDelaySecs;
+	std::atomic<int> m_DistanceEngine;
+	std::atomic<bool> m_bEllipsoid;
+	std::atomic<bool> m_bResetTrip;
+	std::atomic<int> m_WatchdogPeriods;
+
+	// Owned by the worker thread
+	NMEA0183 m_NMEA0183;
+	wxString m_Sentence;
+	iirfilter mSOGFilter;
+	TripLog m_Journal;
+	OdometerSnapshot m_State;
+	OdometerCadence m_GGACadence;   // GGA of any talker, for sources without their own
+	wxLongLong_t mRMC_Watchdog;     // Local clock ms of the last integrated fix
+	unsigned long m_WatchdogWait;   // Until the next watchdog is due, in ms
+	OdometerSentenceStats m_SentenceStats;
+
+	// Sources seen on the bus, only the primary one is integrated
+	OdometerSource m_Sources[ODOMETER_MAX_SOURCES];
+	int m_SourceCount;
+	OdometerSource *m_pPrimary;
+	int m_GGASatsInUse;         // From the last GGA of any talker, for sources without one
+	double m_GGAHDOPlevel;
+
+	// Distance integration, driven by the RMC fix time
+	int StartDelay;
+	wxLongLong_t EnabledTime;   // Fix time in ms from which distance is counted
+	bool m_bHaveFix;            // Previous fix below is usable
+	long m_LastFixDay;          // Counts on through midnight when the date is missing
+	double m_LastFixSeconds;
+	double m_LastFixSpeed;
+
+	// Last position counted by the position engine
+	bool m_bHaveAnchor;
+	double m_AnchorLatitude;
+	double m_AnchorLongitude;
+	double m_AnchorElapsed;     // Seconds since the anchor was set, negative if unknown
+
+	// Published copy of m_State and m_SentenceStats
+	wxCriticalSection m_SnapshotLock;
+	OdometerSnapshot m_Snapshot;
+	OdometerSentenceStats m_PublishedStats;
+};
+
+#endif // _ODOMETERWORKER_H_
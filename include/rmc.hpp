@@ -61,6 +61,13 @@ class RMC : public RESPONSE
       double           MagneticVariation;
       EASTWEST         MagneticVariationDirection;
 
+      /*
+      ** UTCTime and Date decoded, -1 when the field is empty or malformed
+      */
+
+      double           UTCSecondsOfDay;
+      long             UTCDayNumber;    // Days since 1 January 1970
+
       /*
       ** Methods
       */
@@ -48,10 +48,32 @@
 
 class LATLONG;
 
+/*
+** A sentence is split once into an index of fields over a contiguous
+** byte buffer, all field accessors read from that index.
+*/
+
+#define NMEA0183_MAX_FIELDS 48
+
+typedef struct _nmea0183_field
+{
+   unsigned short Offset; // Offset of the first character in the byte buffer
+   unsigned short Length; // Number of characters, may be zero
+} NMEA0183_FIELD;
+
 class SENTENCE 
 {
 //   DECLARE_DYNAMIC( SENTENCE)
 
+   private:
+
+      mutable std::string    m_Buffer;
+      mutable NMEA0183_FIELD m_Fields[ NMEA0183_MAX_FIELDS ];
+      mutable int            m_NumberOfFields;     // -1 when the index is stale
+      mutable int            m_NumberOfDataFields;
+      mutable int            m_ChecksumField;      // Field starting with '*', -1 if none
+      mutable unsigned char  m_Checksum;           // Computed while splitting the fields
+
    public:
 
       SENTENCE();
@@ -71,17 +93,30 @@ class SENTENCE
       virtual unsigned char ComputeChecksum( void) const;
       virtual COMMUNICATIONS_MODE CommunicationsMode( int field_number) const;
       virtual double Double( int field_number) const;
+      virtual NMEA0183_FIELD_STATUS DecodeDouble( int field_number, double *value) const;
+      virtual NMEA0183_FIELD_STATUS DecodeInteger( int field_number, int *value) const;
+      virtual NMEA0183_FIELD_STATUS DecodeTimeOfDay( int field_number, double *seconds) const;
+      virtual NMEA0183_FIELD_STATUS DecodeDate( int field_number, long *days) const;
       virtual EASTWEST EastOrWest( int field_number) const;
       virtual const wxString& Field( int field_number) const;
       virtual void Finish( void);
       virtual int GetNumberOfDataFields( void) const;
       virtual int Integer( int field_number) const;
       virtual NMEA0183_BOOLEAN IsChecksumBad( int checksum_field_number) const;
+      virtual NMEA0183_BOOLEAN IsChecksumBad( void) const;
       virtual LEFTRIGHT LeftOrRight( int field_number) const;
       virtual NORTHSOUTH NorthOrSouth( int field_number) const;
       virtual REFERENCE Reference( int field_number) const;
       virtual TRANSDUCER_TYPE TransducerType( int field_number) const;
 
+      /*
+      ** Field index
+      */
+
+      virtual void Tokenize( void) const;
+      const char *FieldData( int field_number, size_t *length) const;
+      char FieldCharacter( int field_number) const;
+
       /*
       ** Operators
       */
@@ -0,0 +1,86 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _SENTENCERING_H_
+#define _SENTENCERING_H_
+
+#include <atomic>
+
+// NMEA 0183 limits a sentence to 82 characters including $ and CR LF
+#define RAW_SENTENCE_LENGTH 96
+
+// Number of sentences that can be queued, must be a power of two
+#define SENTENCE_RING_SIZE 256
+
+struct RawSentence {
+	unsigned short Length;
+	char Data[RAW_SENTENCE_LENGTH];
+};
+
+//
+// CLASS:
+//    SentenceRing
+//
+// DESCRIPTION:
+//    Lock-free single producer / single consumer ring of fixed size slots.
+//    The producer fills the slot returned by Claim() in place and makes it
+//    visible with Publish(), the consumer reads Front() and frees it with
+//    Release(). Neither side ever allocates or blocks.
+//
+template <typename T, unsigned int N>
+class SentenceRing {
+public:
+	SentenceRing() : m_head(0), m_tail(0) {}
+
+	// Producer side, returns NULL when the ring is full
+	T *Claim() {
+		unsigned int head = m_head.load(std::memory_order_relaxed);
+		if (head - m_tail.load(std::memory_order_acquire) >= N) return NULL;
+		return &m_slots[head & (N - 1)];
+	}
+	void Publish() {
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Consumer side, returns NULL when the ring is empty
+	const T *Front() {
+		unsigned int tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_head.load(std::memory_order_acquire)) return NULL;
+		return &m_slots[tail & (N - 1)];
+	}
+	void Release() {
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+private:
+	T m_slots[N];
+	// Keep producer and consumer indices on separate cache lines
+	std::atomic<unsigned int> m_head;
+	char m_pad[64];
+	std::atomic<unsigned int> m_tail;
+};
+
+#endif // _SENTENCERING_H_
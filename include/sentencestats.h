@@ -0,0 +1,95 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _SENTENCESTATS_H_
+#define _SENTENCESTATS_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+// Talker and sentence type pairs tracked, later ones are counted together
+#define SENTENCE_STATS_ENTRIES 16
+
+// Seconds of accepted fixes reported in the fix rates
+#define SENTENCE_STATS_WINDOW 60
+// Slots kept, one more for the second still being counted
+#define SENTENCE_STATS_SLOTS (SENTENCE_STATS_WINDOW + 1)
+
+// What happened to the sentences of a talker and type
+enum {
+	SENTENCE_RECEIVED,          // Reached the worker
+	SENTENCE_PARSED,            // Parsed, whatever it contained
+	SENTENCE_BAD_CHECKSUM,
+	SENTENCE_INVALID,           // RMC status not A (IsDataValid != NTrue)
+	SENTENCE_GATED,             // Valid RMC below the SatsInUse/HDOP gates
+	SENTENCE_EXPIRED,           // Watchdog expired while this talker was integrated
+	SENTENCE_FIXES,             // RMC fixes that passed the gates
+	SENTENCE_COUNTERS
+};
+
+struct SentenceStatsEntry {
+	char Talker[3];
+	char Mnemonic[4];
+	unsigned long Counts[SENTENCE_COUNTERS];
+	// Fixes in each of the last seconds, a slot is stale unless its second matches
+	wxLongLong_t Second[SENTENCE_STATS_SLOTS];
+	unsigned short Fixes[SENTENCE_STATS_SLOTS];
+};
+
+//
+// CLASS:
+//    OdometerSentenceStats
+//
+// DESCRIPTION:
+//    Running counts of what became of the sentences of each talker ID and
+//    mnemonic, and the rate of accepted fixes over the last 1, 10 and 60
+//    seconds. Tells an undercounting odometer that was missing fixes from
+//    one that rejected them. Plain data, owned by the worker thread and
+//    copied whole into its published snapshot.
+//
+class OdometerSentenceStats {
+public:
+	OdometerSentenceStats();
+
+	void Count(const char *talker, const char *mnemonic, int counter);
+	void CountFix(const char *talker, wxLongLong_t now);
+
+	int GetCount() const { return m_Count; }
+	const SentenceStatsEntry &GetEntry(int index) const { return m_Entries[index]; }
+	double FixRate(int index, wxLongLong_t now, int seconds) const;
+	wxString Report(wxLongLong_t now) const;   // now -1 leaves out the fix rates
+
+private:
+	SentenceStatsEntry *Find(const char *talker, const char *mnemonic);
+
+	SentenceStatsEntry m_Entries[SENTENCE_STATS_ENTRIES];
+	int m_Count;
+};
+
+#endif // _SENTENCESTATS_H_
@@ -0,0 +1,140 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _TRIPINDEX_H_
+#define _TRIPINDEX_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/thread.h>
+
+#include "mappedfile.h"
+
+struct TripLogRecord;
+
+// Common header of both index files
+struct TripIndexHeader {
+	wxUint32 Magic;
+	wxUint32 Version;
+	wxUint32 RecordSize;
+	wxUint32 Count;             // Records in use
+	wxInt64  FirstDay;          // Day index: day number of the first record
+	wxInt64  IndexedOffset;     // Trip index: journal offset indexed up to
+	wxUint32 IndexedSequence;   // Trip index: last journal sequence indexed
+	wxUint32 Reserved[7];
+};
+
+// One trip, from a trip reset to the next
+struct TripIndexEntry {
+	wxInt64  StartTime;         // Milliseconds since 1970 UTC
+	wxInt64  EndTime;
+	wxInt64  LogOffset;         // Journal offset of the first record of the trip
+	double   Distance;          // Nautical miles
+	double   MaxSpeed;          // Knots
+	double   UnderwaySeconds;
+	wxUint32 Fixes;
+	wxUint32 Reserved[3];
+};
+
+// One UTC day, record n is day FirstDay + n
+struct DayIndexEntry {
+	double   Distance;          // Nautical miles on this day
+	double   Cumulative;        // Nautical miles up to and including this day
+	double   MaxSpeed;
+	double   UnderwaySeconds;
+};
+
+// Totals in nautical miles, as shown in the preferences
+struct TripHistorySummary {
+	double Today;
+	double Last7Days;
+	double Season;              // Since 1 January, UTC
+	double AllTime;
+	double LongestTrip;
+	double MaxSpeed;
+	double AverageSpeed;        // Underway, over all trips
+	unsigned long Trips;
+};
+
+//
+// CLASS:
+//    TripIndex
+//
+// DESCRIPTION:
+//    Per trip and per day statistics of the trip journal, kept in two memory
+//    mapped files next to it. Records are fixed size and the day records
+//    carry a running total, so any period total is a subtraction and nothing
+//    is read or parsed at startup however long the history is.
+//
+//    Updated by the journal on the worker thread, queries may come from any
+//    thread.
+//
+class TripIndex {
+public:
+	TripIndex();
+	~TripIndex();
+
+	bool Open(const wxString &tripsPath, const wxString &daysPath);
+	void Close();
+	bool IsOpened() const { return m_Trips.IsOpened() && m_Days.IsOpened(); }
+
+	// Journal side
+	wxInt64 GetIndexedOffset();
+	wxUint32 GetIndexedSequence();
+	void Restart();
+	void Rewind(wxInt64 offset, wxUint32 sequence);
+	void Apply(const TripLogRecord &record, wxInt64 offset);
+	void Sync();
+
+	// Queries
+	bool GetSummary(long today, TripHistorySummary *summary);
+	double GetDayDistance(long day);
+	double GetPeriodDistance(long firstDay, long lastDay);
+
+private:
+	TripIndexHeader *TripsHeader() const { return (TripIndexHeader *) m_Trips.Data(); }
+	TripIndexHeader *DaysHeader() const { return (TripIndexHeader *) m_Days.Data(); }
+	TripIndexEntry *TripEntry(wxUint32 index) const;
+	DayIndexEntry *DayEntry(wxUint32 index) const;
+	bool Reserve(MappedFile &file, wxUint32 count, size_t recordSize);
+	bool CheckHeader(MappedFile &file, size_t recordSize);
+	void ResetFile(MappedFile &file, size_t recordSize);
+	TripIndexEntry *StartTrip(const TripLogRecord &record, wxInt64 offset);
+	DayIndexEntry *Day(long day);
+	double CumulativeBefore(long day);
+	double PeriodDistance(long firstDay, long lastDay);
+
+	wxCriticalSection m_Lock;
+	MappedFile m_Trips;
+	MappedFile m_Days;
+	wxInt64 m_LastFixTime;
+};
+
+#endif // _TRIPINDEX_H_
@@ -0,0 +1,132 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _TRIPLOG_H_
+#define _TRIPLOG_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/file.h>
+
+#include "tripindex.h"
+
+// Records written between two syncs to disk
+#define TRIPLOG_SYNC_RECORDS 10
+
+// Record types
+enum {
+	TRIPLOG_FIX = 1,
+	TRIPLOG_CHECKPOINT = 2
+};
+
+// Record flags
+enum {
+	TRIPLOG_FLAG_VALID      = 1 << 0,  // Fix passed the satellite/HDOP gates
+	TRIPLOG_FLAG_POSITION   = 1 << 1,  // Latitude/Longitude are set
+	TRIPLOG_FLAG_GAP        = 1 << 2,  // Distance integration restarted at this fix
+	TRIPLOG_FLAG_NO_DATE    = 1 << 3,  // Time counted from the time of day only
+	TRIPLOG_FLAG_TRIP_RESET = 1 << 4   // Checkpoint written by a trip reset
+};
+
+// Fixed size journal record, native byte order. For a checkpoint Distance
+// and Trip hold the running totals, for a fix Distance is the increment.
+struct TripLogRecord {
+	wxUint16 Type;
+	wxUint16 Flags;
+	wxUint32 Sequence;      // Strictly increasing, detects stale records
+	wxInt64  Time;          // Milliseconds since 1970 UTC
+	double   Latitude;      // Signed decimal degrees
+	double   Longitude;
+	double   Speed;         // Knots
+	double   Distance;      // Nautical miles
+	double   Trip;          // Nautical miles
+	wxUint32 Reserved;
+	wxUint32 Checksum;      // Over all preceding bytes
+};
+
+//
+// CLASS:
+//    TripLog
+//
+// DESCRIPTION:
+//    Append only journal of the distance run, so that the total and trip
+//    distances survive a crash or power loss. Fixes are merged to at most
+//    one record per second, written with batched syncs, and a checkpoint
+//    with the running totals is written every minute. Open() rebuilds the
+//    totals from the last checkpoint and the fixes that follow it. Records
+//    only reach the trip index once they are synced, so the index is never
+//    ahead of the journal.
+//
+//    Only used from the odometer worker thread.
+//
+class TripLog {
+public:
+	TripLog();
+	~TripLog();
+
+	bool Open(const wxString &path, double seedTotal, double seedTrip);
+	void Close();
+	bool IsOpened() const { return m_File.IsOpened(); }
+
+	double GetTotal() const { return m_Total; }
+	double GetTrip() const { return m_Trip; }
+
+	void AddFix(wxInt64 time, double latitude, double longitude, double speed, double distance, int flags);
+	void ResetTrip();
+	void Sync();
+
+	// Trip and day statistics, safe to query from any thread
+	TripIndex &GetIndex() { return m_Index; }
+
+private:
+	bool ReadRecord(wxFileOffset index, TripLogRecord *record);
+	void Append(TripLogRecord &record);
+	void FlushPending();
+	void Checkpoint(int flags);
+
+	wxFile m_File;
+	TripIndex m_Index;
+	wxUint32 m_Sequence;
+	double m_Total;
+	double m_Trip;
+
+	// Fixes merged into the next record
+	bool m_bPending;
+	TripLogRecord m_Pending;
+
+	wxInt64 m_LastTime;
+	wxInt64 m_LastCheckpoint;
+	// Written but not yet synced, applied to the index by Sync()
+	int m_UnsyncedRecords;
+	TripLogRecord m_Unsynced[TRIPLOG_SYNC_RECORDS];
+	wxFileOffset m_UnsyncedOffset[TRIPLOG_SYNC_RECORDS];
+};
+
+#endif // _TRIPLOG_H_
@@ -0,0 +1,67 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef _VALUEFORMAT_H_
+#define _VALUEFORMAT_H_
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+// Enough for any width and value an instrument shows, including the terminator
+#define VALUE_FORMAT_BUFFER 32
+
+//
+// CLASS:
+//    OdometerValueFormat
+//
+// DESCRIPTION:
+//    Fixed decimals formatting of instrument values into a caller's stack
+//    buffer, for the "%[-][width][.precision]f" formats of the instruments.
+//    The value is first scaled and rounded to its last shown digit, so the
+//    caller can compare that integer with the previous one and skip the
+//    formatting altogether while the displayed value does not change.
+//
+class OdometerValueFormat {
+public:
+	OdometerValueFormat();
+
+	bool Parse(const wxString &format);
+	bool IsFixed() const { return m_bFixed; }
+	long long Scaled(double value) const;
+	size_t Print(long long scaled, char *buffer, size_t size) const;
+
+private:
+	bool m_bFixed;              // The format was understood, otherwise use printf
+	bool m_bLeft;               // '-' flag, pad on the right
+	int m_Width;
+	int m_Precision;
+	double m_Scale;             // 10 ^ m_Precision
+};
+
+#endif // _VALUEFORMAT_H_
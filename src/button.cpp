@@ -145,7 +145,7 @@ wxSize OdometerInstrument_Button::GetSize(int orient, wxSize hint) {
 
 }
 
-void OdometerInstrument_Button::SetData(int st, double data, wxString unit) {
+void OdometerInstrument_Button::SetData(int st, double data, const wxString &unit) {
 }
 
 void OdometerInstrument_Button::Draw(wxGCDC* dc) {
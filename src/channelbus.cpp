@@ -0,0 +1,65 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "channelbus.h"
+#include <cmath>
+
+OdometerChannelBus::OdometerChannelBus() {
+    m_Sequence = 0;
+    for (int i = 0; i < ODOMETER_CHANNEL_COUNT; i++) {
+        m_Channels[i].Version = 0;
+        m_Channels[i].Value = 0.0;
+    }
+}
+
+// Slot of a single OCPN_DBP_STC_ bit, -1 for anything else
+int OdometerChannelBus::ChannelIndex(int channel) {
+    for (int i = 0; i < ODOMETER_CHANNEL_COUNT; i++) {
+        if (channel == (1 << i)) return i;
+    }
+    return -1;
+}
+
+// Returns true if the value differs from the one already published
+bool OdometerChannelBus::Publish(int channel, double value, const wxString &text) {
+    int index = ChannelIndex(channel);
+    if (index < 0) return false;
+
+    OdometerChannel &slot = m_Channels[index];
+    bool sameValue = (slot.Value == value) || (std::isnan(slot.Value) && std::isnan(value));
+    if ((slot.Version != 0) && sameValue && (slot.Text == text)) return false;
+
+    slot.Value = value;
+    slot.Text = text;
+    slot.Version = ++m_Sequence;
+    return true;
+}
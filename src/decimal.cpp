@@ -0,0 +1,272 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  NMEA0183 Support Classes
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+
+#include "nmea0183.h"
+
+/*
+** Decoders for NMEA 0183 numeric fields. They work on the raw field bytes,
+** never allocate and do not depend on the C locale decimal separator.
+**
+** Numeric fields are [+|-]digits[.digits], at least one digit is required.
+** Up to 15 significant digits convert exactly as strtod() would.
+*/
+
+static const double powers_of_ten[] =
+{
+   1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAXIMUM_EXACT_POWER 22
+#define MAXIMUM_MANTISSA_DIGITS 19
+
+NMEA0183_FIELD_STATUS DecimalValue( const char *field, size_t length, double *value )
+{
+   size_t index = 0;
+   bool negative = false;
+
+   if ( length == 0 )
+   {
+      return( FieldEmpty );
+   }
+
+   if ( field[ 0 ] == '-' || field[ 0 ] == '+' )
+   {
+      negative = ( field[ 0 ] == '-' );
+      index++;
+   }
+
+   unsigned long long mantissa = 0;
+   int mantissa_digits = 0;
+   int exponent = 0;
+   int digits = 0;
+   bool decimal_point = false;
+
+   for ( ; index < length; index++ )
+   {
+      char character = field[ index ];
+
+      if ( character >= '0' && character <= '9' )
+      {
+         digits++;
+
+         if ( mantissa_digits < MAXIMUM_MANTISSA_DIGITS )
+         {
+            mantissa = mantissa * 10 + (unsigned long long) ( character - '0' );
+
+            if ( mantissa != 0 )
+            {
+               mantissa_digits++;
+            }
+
+            if ( decimal_point )
+            {
+               exponent--;
+            }
+         }
+         else if ( !decimal_point )
+         {
+            // Digits beyond the mantissa only scale the integer part
+            exponent++;
+         }
+      }
+      else if ( character == '.' && !decimal_point )
+      {
+         decimal_point = true;
+      }
+      else
+      {
+         return( FieldMalformed );
+      }
+   }
+
+   if ( digits == 0 )
+   {
+      return( FieldMalformed );
+   }
+
+   double result = (double) mantissa;
+
+   if ( exponent < 0 )
+   {
+      while ( exponent < -MAXIMUM_EXACT_POWER )
+      {
+         result /= powers_of_ten[ MAXIMUM_EXACT_POWER ];
+         exponent += MAXIMUM_EXACT_POWER;
+      }
+
+      result /= powers_of_ten[ -exponent ];
+   }
+   else if ( exponent > 0 )
+   {
+      while ( exponent > MAXIMUM_EXACT_POWER )
+      {
+         result *= powers_of_ten[ MAXIMUM_EXACT_POWER ];
+         exponent -= MAXIMUM_EXACT_POWER;
+      }
+
+      result *= powers_of_ten[ exponent ];
+   }
+
+   *value = negative ? -result : result;
+
+   return( FieldValid );
+}
+
+NMEA0183_FIELD_STATUS IntegerValue( const char *field, size_t length, int *value )
+{
+   size_t index = 0;
+   bool negative = false;
+
+   if ( length == 0 )
+   {
+      return( FieldEmpty );
+   }
+
+   if ( field[ 0 ] == '-' || field[ 0 ] == '+' )
+   {
+      negative = ( field[ 0 ] == '-' );
+      index++;
+   }
+
+   if ( index == length )
+   {
+      return( FieldMalformed );
+   }
+
+   long long result = 0;
+
+   for ( ; index < length; index++ )
+   {
+      char character = field[ index ];
+
+      if ( character < '0' || character > '9' )
+      {
+         return( FieldMalformed );
+      }
+
+      result = result * 10 + ( character - '0' );
+
+      if ( result > 0x7FFFFFFF )
+      {
+         return( FieldMalformed );
+      }
+   }
+
+   *value = negative ? (int) -result : (int) result;
+
+   return( FieldValid );
+}
+
+/*
+** Time fields are hhmmss[.sss], returned as seconds since midnight UTC.
+** Date fields are ddmmyy, returned as days since 1 January 1970. Years
+** 80 to 99 are taken as 19yy, as GPS receivers cannot report earlier dates.
+*/
+
+static int two_digits( const char *field )
+{
+   if ( field[ 0 ] < '0' || field[ 0 ] > '9' || field[ 1 ] < '0' || field[ 1 ] > '9' )
+   {
+      return( -1 );
+   }
+
+   return( ( field[ 0 ] - '0' ) * 10 + ( field[ 1 ] - '0' ) );
+}
+
+NMEA0183_FIELD_STATUS TimeOfDayValue( const char *field, size_t length, double *seconds )
+{
+   if ( length == 0 )
+   {
+      return( FieldEmpty );
+   }
+
+   if ( length < 6 )
+   {
+      return( FieldMalformed );
+   }
+
+   int hours   = two_digits( field );
+   int minutes = two_digits( field + 2 );
+   double whole_seconds;
+
+   // Seconds may carry the fraction, 60 is allowed for a leap second
+   if ( hours < 0 || hours > 23 || minutes < 0 || minutes > 59 ||
+        field[ 4 ] == '-' || field[ 4 ] == '+' ||
+        DecimalValue( field + 4, length - 4, &whole_seconds ) != FieldValid ||
+        whole_seconds >= 61.0 )
+   {
+      return( FieldMalformed );
+   }
+
+   *seconds = hours * 3600.0 + minutes * 60.0 + whole_seconds;
+
+   return( FieldValid );
+}
+
+NMEA0183_FIELD_STATUS DateValue( const char *field, size_t length, long *days )
+{
+   if ( length == 0 )
+   {
+      return( FieldEmpty );
+   }
+
+   if ( length != 6 )
+   {
+      return( FieldMalformed );
+   }
+
+   int day   = two_digits( field );
+   int month = two_digits( field + 2 );
+   int year  = two_digits( field + 4 );
+
+   if ( day < 1 || day > 31 || month < 1 || month > 12 || year < 0 )
+   {
+      return( FieldMalformed );
+   }
+
+   year += ( year >= 80 ) ? 1900 : 2000;
+
+   /*
+   ** Days from civil, counting years from March so that the leap day
+   ** is the last day of the year
+   */
+
+   if ( month <= 2 )
+   {
+      year--;
+   }
+
+   long era = year / 400;
+   long year_of_era = year - era * 400;
+   long day_of_year = ( 153 * ( month > 2 ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1;
+   long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+   *days = era * 146097 + day_of_era - 719468;
+
+   return( FieldValid );
+}
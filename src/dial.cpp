@@ -83,6 +83,9 @@ OdometerInstrument_Dial::OdometerInstrument_Dial(wxWindow *parent, wxWindowID id
       m_MarkerOffset = 1;
       m_LabelOption = DIAL_LABEL_HORIZONTAL;
       m_LabelArray = wxArrayString();
+      m_StaticTitleHeight = 0;
+      m_StaticMin = m_StaticMax = 0;
+      m_bGeometryValid = false;
 }
 
 OdometerInstrument_Dial::~OdometerInstrument_Dial(void) {
@@ -92,12 +95,21 @@ void OdometerInstrument_Dial::SetOptionMarker(double step, DialMarkerOption opti
 	m_MarkerStep = step; 
 	m_MarkerOption = option; 
 	m_MarkerOffset = offset; 
+	m_StaticLayer = wxNullBitmap;
+	m_bGeometryValid = false;
 }
 
 void OdometerInstrument_Dial::SetOptionLabel(double step, DialLabelOption option, wxArrayString labels) { 
 	m_LabelStep = step; 
 	m_LabelOption = option; 
 	m_LabelArray = labels;
+	m_StaticLayer = wxNullBitmap;
+	m_bGeometryValid = false;
+}
+
+// Every color of the static layer comes from the scheme
+void OdometerInstrument_Dial::SetColorScheme(PI_ColorScheme cs) {
+	m_StaticLayer = wxNullBitmap;
 }
 
 void OdometerInstrument_Dial::SetOptionMainValue(wxString format, DialPositionOption option) {
@@ -126,43 +138,104 @@ wxSize OdometerInstrument_Dial::GetSize(int orient, wxSize hint) {
       }
 }
 
-void OdometerInstrument_Dial::SetData(int st, double data, wxString unit) {
+void OdometerInstrument_Dial::SetData(int st, double data, const wxString &unit) {
+      // NaN compares unequal to itself, but draws the same every time
       if (st == m_MainValueCap) {
+            if (!(data == m_MainValue || (std::isnan(data) && std::isnan(m_MainValue))) ||
+                unit != m_MainValueUnit) m_bDamaged = true;
             m_MainValue = data;
             m_MainValueUnit = unit;
       }
       else if (st == m_ExtraValueCap) {
+            if (!(data == m_ExtraValue || (std::isnan(data) && std::isnan(m_ExtraValue))) ||
+                unit != m_ExtraValueUnit) m_bDamaged = true;
             m_ExtraValue = data;
             m_ExtraValueUnit = unit;
       }
 }
 
+// Only the value and the needle change from one paint to the next, the rest of
+// the dial is blitted from m_StaticLayer. It is drawn again when the size, the
+// label font or the range changes, SetColorScheme() drops it.
 void OdometerInstrument_Dial::Draw(wxGCDC* bdc) {
-    wxColour c1;
-    GetGlobalColor(_T("DASHB"), &c1);
-    wxBrush b1(c1);
-    bdc->SetBackground(b1);
-    bdc->Clear();
-
     wxSize size = GetClientSize();
     m_cx = size.x / 2;
     int availableHeight = size.y - m_TitleHeight - 6;
-    int width, height;
-    bdc->GetTextExtent(_T("000"), &width, &height, 0, 0, g_pFontLabel);
     m_cy = m_TitleHeight + 2;
     m_cy += availableHeight / 2;
     m_radius = availableHeight / 2;
+    if (!m_bGeometryValid) UpdateGeometry();
 
+    if (!m_StaticLayer.IsOk() || (size != m_StaticSize) || (m_TitleHeight != m_StaticTitleHeight) ||
+        (*g_pFontSmall != m_StaticFont) || (m_MainValueMin != m_StaticMin) || (m_MainValueMax != m_StaticMax)) {
+        RenderStaticLayer(size);
+    }
+    bdc->DrawBitmap(m_StaticLayer, 0, 0, false);
 
-    DrawLabels(bdc);
-    DrawFrame(bdc);
-    DrawMarkers(bdc);
-    DrawBackground(bdc);
     DrawData(bdc, m_MainValue, m_MainValueUnit, m_MainValueFormat, m_MainValueOption);
     DrawData(bdc, m_ExtraValue, m_ExtraValueUnit, m_ExtraValueFormat, m_ExtraValueOption);
     DrawForeground(bdc);
 }
 
+// Steps round the dial the same way the markers and labels always have, from
+// the start angle by the angle between two of them
+int OdometerInstrument_Dial::BuildDirections(DialDirection *dir, int start, int range, double step, double span) {
+    int diff_angle = start + range - ANGLE_OFFSET;
+    // angle between markers
+    double abm = range * step / span;
+    // don't draw last value, it's already done as first
+    if (range == 360) diff_angle -= abm;
+
+    int count = 0;
+    for (double angle = start - ANGLE_OFFSET; (angle <= diff_angle) && (count < DIAL_MAX_MARKERS); angle += abm) {
+        dir[count].Angle = angle;
+        dir[count].Cos = cos(deg2rad(angle));
+        dir[count].Sin = sin(deg2rad(angle));
+        count++;
+    }
+    return count;
+}
+
+void OdometerInstrument_Dial::UpdateGeometry() {
+    double span = m_MainValueMax - m_MainValueMin;
+    m_MarkerCount = BuildDirections(m_MarkerDir, m_AngleStart, m_AngleRange, m_MarkerStep, span);
+    m_LabelCount = BuildDirections(m_LabelDir, m_AngleStart, m_AngleRange, m_LabelStep, span);
+
+    // The needle pointing at 3 o'clock, DrawForeground() rotates it into place
+    static const double needle[DIAL_NEEDLE_POINTS][2] = {
+        { 0.95, -.010 }, { 0.95, .015 }, { 0.22, 2.8 }, { 0.22, -2.8 }
+    };
+    for (int i = 0; i < DIAL_NEEDLE_POINTS; i++) {
+        m_Needle[i].m_x = needle[i][0] * cos(needle[i][1]);
+        m_Needle[i].m_y = needle[i][0] * sin(needle[i][1]);
+    }
+    m_bGeometryValid = true;
+}
+
+void OdometerInstrument_Dial::RenderStaticLayer(const wxSize &size) {
+    wxColour back;
+    GetGlobalColor(_T("DASHB"), &back);
+    m_StaticLayer.Create(size.x, size.y);
+    wxMemoryDC mdc(m_StaticLayer);
+    {
+        wxGCDC gdc(mdc);
+        gdc.SetBackground(wxBrush(back));
+        gdc.Clear();
+
+        DrawLabels(&gdc);
+        DrawFrame(&gdc);
+        DrawMarkers(&gdc);
+        DrawBackground(&gdc);
+    }
+    mdc.SelectObject(wxNullBitmap);
+
+    m_StaticSize = size;
+    m_StaticTitleHeight = m_TitleHeight;
+    m_StaticFont = *g_pFontSmall;
+    m_StaticMin = m_MainValueMin;
+    m_StaticMax = m_MainValueMax;
+}
+
 void OdometerInstrument_Dial::DrawFrame(wxGCDC* dc) {
     wxSize size = GetClientSize();
     wxColour cl;
@@ -332,16 +405,10 @@ void OdometerInstrument_Dial::DrawMarkers(wxGCDC* dc) {
     wxPen pen(cl, penwidth, wxPENSTYLE_SOLID);
     dc->SetPen(pen);
 
-    int diff_angle = m_AngleStart + m_AngleRange - ANGLE_OFFSET;
-    // angle between markers
-    double abm = m_AngleRange * m_MarkerStep / (m_MainValueMax - m_MainValueMin);
-    // don't draw last value, it's already done as first
-    if (m_AngleRange == 360) diff_angle -= abm;
-
-    int offset = 0;
-    for (double angle = m_AngleStart - ANGLE_OFFSET; angle <= diff_angle; angle += abm) {
+    for (int offset = 0; offset < m_MarkerCount; offset++) {
+        const DialDirection &dir = m_MarkerDir[offset];
         if (m_MarkerOption == DIAL_MARKER_REDGREEN) {
-            int a = int(angle + ANGLE_OFFSET) % 360;
+            int a = int(dir.Angle + ANGLE_OFFSET) % 360;
             if (a > 180) GetGlobalColor(_T("DASHR"), &cl);
             else if ((a > 0) && (a < 180)) GetGlobalColor(_T("DASHG"), &cl);
             else
@@ -355,12 +422,11 @@ void OdometerInstrument_Dial::DrawMarkers(wxGCDC* dc) {
         if (offset % m_MarkerOffset) {
             size = 0.96;
         }
-        offset++;
 
-        dc->DrawLine(m_cx + ((m_radius-1) * size * cos(deg2rad(angle))),
-                m_cy + ((m_radius-1) * size * sin(deg2rad(angle))),
-                m_cx + ((m_radius-1) * cos(deg2rad(angle))),
-                m_cy + ((m_radius-1) * sin(deg2rad(angle))));
+        dc->DrawLine(m_cx + ((m_radius-1) * size * dir.Cos),
+                m_cy + ((m_radius-1) * size * dir.Sin),
+                m_cx + ((m_radius-1) * dir.Cos),
+                m_cy + ((m_radius-1) * dir.Sin));
     }
     // We must reset pen color so following drawings are fine
     if (m_MarkerOption == DIAL_MARKER_REDGREEN) {
@@ -398,18 +464,13 @@ void OdometerInstrument_Dial::DrawLabels(wxGCDC* dc)
       dc->SetFont(*g_pFontSmall);
       dc->SetTextForeground(cl);
 
-      int diff_angle = m_AngleStart + m_AngleRange - ANGLE_OFFSET;
-      // angle between markers
-      double abm = m_AngleRange * m_LabelStep / (m_MainValueMax - m_MainValueMin);
-      // don't draw last value, it's already done as first
-      if (m_AngleRange == 360) diff_angle -= abm;
-
-      int offset = 0;
       int value = m_MainValueMin;
       int width, height;
 	  wxString label;
 
-      for (double angle = m_AngleStart - ANGLE_OFFSET; angle <= diff_angle; angle += abm) {
+      for (int offset = 0; offset < m_LabelCount; offset++) {
+            const DialDirection &dir = m_LabelDir[offset];
+            double angle = dir.Angle;
 		  if (m_LabelOption == DIAL_LABEL_FRACTIONS) {
 			  if (value == 0) {
 				  label = "0";
@@ -443,8 +504,8 @@ void OdometerInstrument_Dial::DrawLabels(wxGCDC* dc)
                   double halfH = height / 2;
                   //double delta = sqrt(width*width+height*height);
                   double delta = sqrt(halfW*halfW+halfH*halfH);
-                  TextPoint.x = m_cx + ((m_radius * 0.90) - delta) * cos(deg2rad(angle)) - halfW;
-                  TextPoint.y = m_cy + ((m_radius * 0.90) - delta) * sin(deg2rad(angle)) - halfH;
+                  TextPoint.x = m_cx + ((m_radius * 0.90) - delta) * dir.Cos - halfW;
+                  TextPoint.y = m_cy + ((m_radius * 0.90) - delta) * dir.Sin - halfH;
 
 #ifdef __WXMSW__
                   if (g_pFontSmall->GetPointSize() <= 12)
@@ -473,7 +534,6 @@ void OdometerInstrument_Dial::DrawLabels(wxGCDC* dc)
                      dc->DrawRotatedText(label, TextPoint, -90 - angle);
 
             }
-            offset++;
             value += m_LabelStep;
       }
 
@@ -646,15 +706,14 @@ void OdometerInstrument_Dial::DrawForeground(wxGCDC* dc) {
 
       double value = deg2rad((val - m_MainValueMin) * m_AngleRange / (m_MainValueMax - m_MainValueMin)) + deg2rad(m_AngleStart - ANGLE_OFFSET);
 
-      wxPoint points[4];
-      points[0].x = m_cx + (m_radius * 0.95 * cos(value - .010));
-      points[0].y = m_cy + (m_radius * 0.95 * sin(value - .010));
-      points[1].x = m_cx + (m_radius * 0.95 * cos(value + .015));
-      points[1].y = m_cy + (m_radius * 0.95 * sin(value + .015));
-      points[2].x = m_cx + (m_radius * 0.22 * cos(value + 2.8));
-      points[2].y = m_cy + (m_radius * 0.22 * sin(value + 2.8));
-      points[3].x = m_cx + (m_radius * 0.22 * cos(value - 2.8));
-      points[3].y = m_cy + (m_radius * 0.22 * sin(value - 2.8));
-      dc->DrawPolygon(4, points, 0, 0);
+      // Rotate the cached outline, one cos/sin pair instead of one per point
+      double c = m_radius * cos(value);
+      double s = m_radius * sin(value);
+      wxPoint points[DIAL_NEEDLE_POINTS];
+      for (int i = 0; i < DIAL_NEEDLE_POINTS; i++) {
+            points[i].x = m_cx + (m_Needle[i].m_x * c - m_Needle[i].m_y * s);
+            points[i].y = m_cy + (m_Needle[i].m_x * s + m_Needle[i].m_y * c);
+      }
+      dc->DrawPolygon(DIAL_NEEDLE_POINTS, points, 0, 0);
 }
 
@@ -0,0 +1,115 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "geodesy.h"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define DEG_TO_RAD (M_PI / 180.0)
+
+// Longitude difference in radians, the short way round the antimeridian
+static double LongitudeDelta(double lon1, double lon2) {
+    double delta = lon2 - lon1;
+    if (delta > 180.0) delta -= 360.0;
+    else if (delta < -180.0) delta += 360.0;
+    return delta * DEG_TO_RAD;
+}
+
+double EquirectangularDistance(double lat1, double lon1, double lat2, double lon2) {
+    double x = LongitudeDelta(lon1, lon2) * cos((lat1 + lat2) / 2.0 * DEG_TO_RAD);
+    double y = (lat2 - lat1) * DEG_TO_RAD;
+    return sqrt(x * x + y * y) * EARTH_RADIUS_NM;
+}
+
+double HaversineDistance(double lat1, double lon1, double lat2, double lon2) {
+    double sinLat = sin((lat2 - lat1) * DEG_TO_RAD / 2.0);
+    double sinLon = sin(LongitudeDelta(lon1, lon2) / 2.0);
+    double a = sinLat * sinLat + cos(lat1 * DEG_TO_RAD) * cos(lat2 * DEG_TO_RAD) * sinLon * sinLon;
+    if (a > 1.0) a = 1.0;
+    return 2.0 * asin(sqrt(a)) * EARTH_RADIUS_NM;
+}
+
+// WGS84 ellipsoid
+#define WGS84_A 6378137.0
+#define WGS84_F (1.0 / 298.257223563)
+#define WGS84_B (WGS84_A * (1.0 - WGS84_F))
+
+double VincentyDistance(double lat1, double lon1, double lat2, double lon2) {
+    double L = LongitudeDelta(lon1, lon2);
+    double U1 = atan((1.0 - WGS84_F) * tan(lat1 * DEG_TO_RAD));
+    double U2 = atan((1.0 - WGS84_F) * tan(lat2 * DEG_TO_RAD));
+    double sinU1 = sin(U1), cosU1 = cos(U1);
+    double sinU2 = sin(U2), cosU2 = cos(U2);
+
+    double lambda = L;
+    double sinSigma = 0.0, cosSigma = 1.0, sigma = 0.0, cosSqAlpha = 1.0, cos2SigmaM = 0.0;
+    int iterations = 100;
+    double lambdaPrev;
+
+    do {
+        double sinLambda = sin(lambda), cosLambda = cos(lambda);
+        double t1 = cosU2 * sinLambda;
+        double t2 = cosU1 * sinU2 - sinU1 * cosU2 * cosLambda;
+        sinSigma = sqrt(t1 * t1 + t2 * t2);
+        if (sinSigma == 0.0) return 0.0;  // Coincident points
+
+        cosSigma = sinU1 * sinU2 + cosU1 * cosU2 * cosLambda;
+        sigma = atan2(sinSigma, cosSigma);
+        double sinAlpha = cosU1 * cosU2 * sinLambda / sinSigma;
+        cosSqAlpha = 1.0 - sinAlpha * sinAlpha;
+        cos2SigmaM = (cosSqAlpha != 0.0) ? cosSigma - 2.0 * sinU1 * sinU2 / cosSqAlpha : 0.0;  // Equatorial line
+        double C = WGS84_F / 16.0 * cosSqAlpha * (4.0 + WGS84_F * (4.0 - 3.0 * cosSqAlpha));
+        lambdaPrev = lambda;
+        lambda = L + (1.0 - C) * WGS84_F * sinAlpha *
+            (sigma + C * sinSigma * (cos2SigmaM + C * cosSigma * (-1.0 + 2.0 * cos2SigmaM * cos2SigmaM)));
+    } while (fabs(lambda - lambdaPrev) > 1e-12 && --iterations > 0);
+
+    if (iterations == 0) return HaversineDistance(lat1, lon1, lat2, lon2);
+
+    double uSq = cosSqAlpha * (WGS84_A * WGS84_A - WGS84_B * WGS84_B) / (WGS84_B * WGS84_B);
+    double A = 1.0 + uSq / 16384.0 * (4096.0 + uSq * (-768.0 + uSq * (320.0 - 175.0 * uSq)));
+    double B = uSq / 1024.0 * (256.0 + uSq * (-128.0 + uSq * (74.0 - 47.0 * uSq)));
+    double deltaSigma = B * sinSigma * (cos2SigmaM + B / 4.0 * (cosSigma * (-1.0 + 2.0 * cos2SigmaM * cos2SigmaM) -
+        B / 6.0 * cos2SigmaM * (-3.0 + 4.0 * sinSigma * sinSigma) * (-3.0 + 4.0 * cos2SigmaM * cos2SigmaM)));
+
+    return WGS84_B * A * (sigma - deltaSigma) / METERS_PER_NM;
+}
+
+// Steps below this size in degrees use the flat earth approximation
+#define SHORT_STEP_DEGREES 0.02
+
+double GeodesicDistance(double lat1, double lon1, double lat2, double lon2, bool ellipsoid) {
+    if (ellipsoid) return VincentyDistance(lat1, lon1, lat2, lon2);
+
+    if (fabs(lat2 - lat1) < SHORT_STEP_DEGREES && fabs(lon2 - lon1) < SHORT_STEP_DEGREES &&
+        fabs(lat1) < 89.0) {
+        return EquirectangularDistance(lat1, lon1, lat2, lon2);
+    }
+    return HaversineDistance(lat1, lon1, lat2, lon2);
+}
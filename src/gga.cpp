@@ -108,10 +108,11 @@ bool GGA::Parse( const SENTENCE& sentence )
    */
 
    /*
-   ** First we check the checksum...
+   ** First we check the checksum, it was computed while the sentence was split.
+   ** Wherever it is, receivers leave out empty trailing fields.
    */
 
-   if ( sentence.IsChecksumBad( 15 ) ==NTrue )
+   if ( sentence.IsChecksumBad( ) == NTrue )
    {
       SetErrorMessage( _T("Invalid Checksum" ));
       return( FALSE );
@@ -121,10 +122,21 @@ bool GGA::Parse( const SENTENCE& sentence )
    Position.Parse( 2, 3, 4, 5, sentence );
    GPSQuality                      = sentence.Integer( 6 );
    NumberOfSatellitesInUse         = sentence.Integer( 7 );
-   HorizontalDilutionOfPrecision   = sentence.Double( 8 );
-   AntennaAltitudeMeters           = sentence.Double( 9 );
-   GeoidalSeparationMeters         = sentence.Double( 11 );
-   AgeOfDifferentialGPSDataSeconds = sentence.Double( 13 );
+
+   // An unknown HDOP is reported as the worst value a receiver can send
+   if ( sentence.DecodeDouble( 8, &HorizontalDilutionOfPrecision ) != FieldValid )
+      HorizontalDilutionOfPrecision = 99.99;
+
+   if ( sentence.DecodeDouble( 9, &AntennaAltitudeMeters ) != FieldValid )
+      AntennaAltitudeMeters = 0.0;
+
+   if ( sentence.DecodeDouble( 11, &GeoidalSeparationMeters ) != FieldValid )
+      GeoidalSeparationMeters = 0.0;
+
+   // Empty when DGPS is not used
+   if ( sentence.DecodeDouble( 13, &AgeOfDifferentialGPSDataSeconds ) != FieldValid )
+      AgeOfDifferentialGPSDataSeconds = 0.0;
+
    DifferentialReferenceStationID  = sentence.Integer( 14 );
 
    return( TRUE );
@@ -0,0 +1,157 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "glyphcache.h"
+
+OdometerGlyphCache::OdometerGlyphCache() {
+    m_bValid = false;
+    m_bFits = false;
+    m_Scale = 1.0;
+    for (int i = 0; i < GLYPH_COUNT; i++) m_Advance[i] = 0;
+    m_Height = 0;
+    m_pRenderer = NULL;
+}
+
+// The glyphs are drawn at the pixel size of the display, scale times their
+// logical size, and scaled back when they are painted
+void OdometerGlyphCache::Build(const wxFont &font, const wxColour &fore, const wxColour &back, double scale) {
+    wxScreenDC sdc;
+    sdc.SetFont(font);
+    m_Height = wxMax(sdc.GetCharHeight(), 1);
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        int width, h;
+        sdc.GetTextExtent(wxString((wxChar) (GLYPH_FIRST + i)), &width, &h);
+        m_Advance[i] = width;
+    }
+    m_bFits = InkFits(sdc, font);
+
+    wxMemoryDC mdc;
+    for (int i = 0; m_bFits && (i < GLYPH_COUNT); i++) {
+        wxString glyph((wxChar) (GLYPH_FIRST + i));
+        m_Glyphs[i].Create(wxMax(wxRound(m_Advance[i] * scale), 1), wxMax(wxRound(m_Height * scale), 1));
+        mdc.SelectObject(m_Glyphs[i]);
+        mdc.SetUserScale(scale, scale);
+        mdc.SetFont(font);
+        mdc.SetBackground(wxBrush(back));
+        mdc.Clear();
+        mdc.SetTextForeground(fore);
+        mdc.DrawText(glyph, 0, 0);
+        mdc.SelectObject(wxNullBitmap);
+    }
+
+    m_Font = font;
+    m_Fore = fore;
+    m_Back = back;
+    m_Scale = scale;
+    m_bValid = true;
+    m_pRenderer = NULL;
+}
+
+// Whether the font can be composed from glyphs cut at their advance widths.
+// Ink left of the origin or right of the advance, as in italic and script
+// fonts, would be clipped, and a string wider or narrower than the sum of
+// its advances, from kerning or fractional advances, would drift.
+bool OdometerGlyphCache::InkFits(wxScreenDC &sdc, const wxFont &font) {
+    wxString all;
+    int widest = 0;
+    int sum = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        all += (wxChar) (GLYPH_FIRST + i);
+        widest = wxMax(widest, m_Advance[i]);
+        sum += m_Advance[i];
+    }
+    int width, h;
+    sdc.GetTextExtent(all, &width, &h);
+    if (width != sum) return false;
+
+    // Each glyph is drawn black on white with room on both sides, any dark
+    // pixel outside its advance is ink the cache would lose. Faint
+    // antialiasing is let through.
+    int pad = wxMax(m_Height / 2, 1);
+    wxBitmap probe(widest + 2 * pad, m_Height);
+    wxMemoryDC mdc;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        mdc.SelectObject(probe);
+        mdc.SetFont(font);
+        mdc.SetBackground(*wxWHITE_BRUSH);
+        mdc.Clear();
+        mdc.SetTextForeground(*wxBLACK);
+        mdc.DrawText(wxString((wxChar) (GLYPH_FIRST + i)), pad, 0);
+        mdc.SelectObject(wxNullBitmap);
+
+        wxImage image = probe.ConvertToImage();
+        for (int x = 0; x < image.GetWidth(); x++) {
+            if ((x >= pad) && (x < pad + m_Advance[i])) continue;
+            for (int y = 0; y < image.GetHeight(); y++) {
+                if (image.GetGreen(x, y) < 128) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// wxGCDC::DrawBitmap() would convert the bitmap on every call, this is done
+// once per glyph and renderer instead
+void OdometerGlyphCache::Convert(wxGraphicsContext *gc) {
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        m_GraphicsGlyphs[i] = gc->CreateBitmap(m_Glyphs[i]);
+    }
+    m_pRenderer = gc->GetRenderer();
+}
+
+// Draws text with its top left corner at x, y. Returns false, having drawn
+// nothing, when the text has a character that is not cached or the font
+// does not fit the cache.
+bool OdometerGlyphCache::DrawText(wxGCDC *dc, const wxFont &font, const wxColour &fore, const wxColour &back,
+    const wxString &text, wxCoord x, wxCoord y) {
+    for (wxString::const_iterator it = text.begin(); it != text.end(); ++it) {
+        wxUniChar c = *it;
+        if ((c < GLYPH_FIRST) || (c > GLYPH_LAST)) return false;
+    }
+
+    wxGraphicsContext *gc = dc->GetGraphicsContext();
+    if (!gc) return false;
+
+    double scale = dc->GetContentScaleFactor();
+    if (!m_bValid || (font != m_Font) || (fore != m_Fore) || (back != m_Back) || (scale != m_Scale)) {
+        Build(font, fore, back, scale);
+    }
+    if (!m_bFits) return false;
+    if (gc->GetRenderer() != m_pRenderer) Convert(gc);
+
+    for (wxString::const_iterator it = text.begin(); it != text.end(); ++it) {
+        int i = (int) ((*it).GetValue() - GLYPH_FIRST);
+        gc->DrawBitmap(m_GraphicsGlyphs[i], x, y, m_Advance[i], m_Height);
+        x += m_Advance[i];
+    }
+    return true;
+}
@@ -55,3 +55,87 @@ int HexValue( const wxString& hex_string)
    return_value = (int)scan_value;
    return( return_value);
 }
+
+/*
+** Checksum fields are "*hh", the checksum is the digits after the '*'. The
+** usual two digits are decoded with a table lookup each. Anything else is
+** read the way sscanf( "%lx" ) did, so "*4a" or "* 4A" are still accepted
+** and a field without digits reads as 0.
+*/
+
+static const signed char hex_digits[ 256 ] =
+{
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+   -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+long ChecksumValue( const char *field, size_t length )
+{
+   if ( length == 3 )
+   {
+      int high = hex_digits[ (unsigned char) field[ 1 ] ];
+      int low  = hex_digits[ (unsigned char) field[ 2 ] ];
+
+      // Both are digits unless one of them is -1
+      if ( ( high | low ) >= 0 )
+      {
+         return( ( high << 4 ) | low );
+      }
+   }
+
+   size_t index = 1;
+
+   while ( index < length && ( field[ index ] == ' ' || field[ index ] == '\t' ||
+           field[ index ] == '\v' || field[ index ] == '\f' ) )
+   {
+      index++;
+   }
+
+   bool negative = false;
+
+   if ( index < length && ( field[ index ] == '-' || field[ index ] == '+' ) )
+   {
+      negative = ( field[ index ] == '-' );
+      index++;
+   }
+
+   if ( index + 2 < length && field[ index ] == '0' && ( field[ index + 1 ] | 0x20 ) == 'x' &&
+        hex_digits[ (unsigned char) field[ index + 2 ] ] >= 0 )
+   {
+      index += 2;
+   }
+
+   // Past 0xFFFF it cannot match a checksum any more, stop growing there
+   long value = 0;
+
+   for ( ; index < length; index++ )
+   {
+      int digit = hex_digits[ (unsigned char) field[ index ] ];
+
+      if ( digit < 0 )
+      {
+         break;
+      }
+
+      if ( value <= 0xFFFF )
+      {
+         value = value * 16 + digit;
+      }
+   }
+
+   return( negative ? -value : value );
+}
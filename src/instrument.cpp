@@ -37,6 +37,7 @@
 #include <cmath>
 
 #include "instrument.h"
+#include "odometerprofile.h"
 //#include "wx28compat.h"
 
 //----------------------------------------------------------------
@@ -49,6 +50,9 @@ OdometerInstrument::OdometerInstrument(wxWindow *pparent, wxWindowID id, wxStrin
       :wxControl(pparent, id, wxDefaultPosition, wxDefaultSize, wxBORDER_NONE) {
       m_title = title;
       m_cap_flag = cap_flag;
+      m_BusSequence = 0;
+      m_bDamaged = true;
+      for (int i = 0; i < ODOMETER_CHANNEL_COUNT; i++) m_ChannelVersion[i] = 0;
 
       SetBackgroundStyle(wxBG_STYLE_CUSTOM);
       SetDrawSoloInPane(false);
@@ -84,6 +88,27 @@ int OdometerInstrument::GetCapacity() {
 	return m_cap_flag;
 }
 
+// Passes the channels this instrument shows to SetData(), but only those that
+// changed since the last call. A new instrument takes every published value.
+// Returns true when the instrument needs to be repainted.
+bool OdometerInstrument::PullChannels(const OdometerChannelBus &bus) {
+    if (bus.GetSequence() != m_BusSequence) {
+        m_BusSequence = bus.GetSequence();
+
+        for (int i = 0; i < ODOMETER_CHANNEL_COUNT; i++) {
+            if (!(m_cap_flag & (1 << i))) continue;
+            const OdometerChannel &channel = bus.GetChannel(i);
+            if (channel.Version == m_ChannelVersion[i]) continue;
+            m_ChannelVersion[i] = channel.Version;
+            SetData(1 << i, channel.Value, channel.Text);
+        }
+    }
+
+    bool damaged = m_bDamaged;
+    m_bDamaged = false;
+    return damaged;
+}
+
 void OdometerInstrument::SetDrawSoloInPane(bool value) {
     m_drawSoloInPane = value;
 }
@@ -122,7 +147,10 @@ void OdometerInstrument::OnPaint(wxPaintEvent& WXUNUSED(event)) {
 #endif
     dc.Clear();
 
-    Draw(&dc);
+    {
+        ODOMETER_PROFILE_SCOPE(PROFILE_DRAW + OdometerChannelBus::ChannelIndex(m_cap_flag & -m_cap_flag));
+        Draw(&dc);
+    }
 
     if (!m_drawSoloInPane) {
 
@@ -170,6 +198,38 @@ void OdometerInstrument::OnPaint(wxPaintEvent& WXUNUSED(event)) {
     }
 }
 
+// Readouts are composed from the cached glyphs of g_pFontData, only text with a
+// character outside the cache, or in a font the cache cannot reproduce, is laid
+// out and rasterized on each paint
+void OdometerInstrument::DrawDataText(wxGCDC* dc, const wxString &text, int height) {
+      wxColour cl;
+      wxColour c2;
+      GetGlobalColor(_T("DASHF"), &cl);
+      GetGlobalColor(_T("DASHB"), &c2);
+      if (g_pGlyphsData->DrawText(dc, *g_pFontData, cl, c2, text, 10, m_TitleHeight)) return;
+
+#ifdef __WXMSW__
+      wxBitmap tbm(dc->GetSize().x, height, -1);
+      wxMemoryDC tdc(tbm);
+      tdc.SetBackground(c2);
+      tdc.Clear();
+
+      tdc.SetFont(*g_pFontData);
+      tdc.SetTextForeground(cl);
+
+      tdc.DrawText(text, 10, 0);
+
+      tdc.SelectObject(wxNullBitmap);
+
+      dc->DrawBitmap(tbm, 0, m_TitleHeight, false);
+#else
+      dc->SetFont(*g_pFontData);
+      dc->SetTextForeground(cl);
+
+      dc->DrawText(text, 10, m_TitleHeight);
+#endif
+}
+
 //----------------------------------------------------------------
 //
 //    OdometerInstrument_Single Implementation
@@ -181,6 +241,10 @@ OdometerInstrument_Single::OdometerInstrument_Single(wxWindow *pparent, wxWindow
       m_format = format;
       m_data = _T("---");
       m_DataHeight = 0;
+      m_ValueFormat.Parse(format);
+      m_bHaveUnit = false;
+      m_bHaveValue = false;
+      m_Scaled = 0;
 }
 
 wxSize OdometerInstrument_Single::GetSize(int orient, wxSize hint) {
@@ -197,64 +261,75 @@ wxSize OdometerInstrument_Single::GetSize(int orient, wxSize hint) {
 }
 
 void OdometerInstrument_Single::Draw(wxGCDC* dc) {
-      wxColour cl;
-#ifdef __WXMSW__
-      wxBitmap tbm(dc->GetSize().x, m_DataHeight, -1);
-      wxMemoryDC tdc(tbm);
-      wxColour c2;
-      GetGlobalColor(_T("DASHB"), &c2);
-      tdc.SetBackground(c2);
-      tdc.Clear();
-
-      tdc.SetFont(*g_pFontData);
-      GetGlobalColor(_T("DASHF"), &cl);
-      tdc.SetTextForeground(cl);
-
-      tdc.DrawText(m_data, 10, 0);
-
-      tdc.SelectObject(wxNullBitmap);
-
-      dc->DrawBitmap(tbm, 0, m_TitleHeight, false);
-#else
-      dc->SetFont(*g_pFontData);
-      GetGlobalColor(_T("DASHF"), &cl);
-      dc->SetTextForeground(cl);
-
-      dc->DrawText(m_data, 10, m_TitleHeight);
-
-#endif
-
+      DrawDataText(dc, m_data, m_DataHeight);
 }
 
-void OdometerInstrument_Single::SetData(int st, double data, wxString unit) {
-      if (m_cap_flag & st) {
-            if (!std::isnan(data) && (data < 999999)) {
-                if (unit == _T("C"))
-                  m_data = wxString::Format(m_format, data)+DEGREE_SIGN+_T("C");
-                else if (unit == _T("\u00B0"))
-                  m_data = wxString::Format(m_format, data)+DEGREE_SIGN;
-                else if (unit == _T("\u00B0T"))
-                  m_data = wxString::Format(m_format, data)+DEGREE_SIGN+_(" true");
-                else if (unit == _T("\u00B0M"))
-                  m_data = wxString::Format(m_format, data)+DEGREE_SIGN+_(" mag");
-                else if (unit == _T("\u00B0L"))
-                  m_data = _T(">")+ wxString::Format(m_format, data)+DEGREE_SIGN;
-                else if (unit == _T("\u00B0R"))
-                  m_data = wxString::Format(m_format, data)+DEGREE_SIGN+_T("<");
-                else if (unit == _T("N")) //Knots
-                  m_data = wxString::Format(m_format, data)+_T(" Kts");
+// Splits the unit into what goes before and after the value, worked out
+// once for each unit rather than on every value
+static void UnitAffixes(const wxString &unit, wxString *prefix, wxString *suffix) {
+      prefix->Empty();
+      if (unit == _T("C"))
+        *suffix = DEGREE_SIGN+_T("C");
+      else if (unit == _T("\u00B0"))
+        *suffix = DEGREE_SIGN;
+      else if (unit == _T("\u00B0T"))
+        *suffix = DEGREE_SIGN+_(" true");
+      else if (unit == _T("\u00B0M"))
+        *suffix = DEGREE_SIGN+_(" mag");
+      else if (unit == _T("\u00B0L")) {
+        *prefix = _T(">");
+        *suffix = DEGREE_SIGN;
+      }
+      else if (unit == _T("\u00B0R"))
+        *suffix = DEGREE_SIGN+_T("<");
+      else if (unit == _T("N")) //Knots
+        *suffix = _T(" Kts");
 /* maybe in the future ...
-                else if (unit == _T("M")) // m/s
-                  m_data = wxString::Format(m_format, data)+_T(" m/s");
-                else if (unit == _T("K")) // km/h
-                  m_data = wxString::Format(m_format, data)+_T(" km/h");
+      else if (unit == _T("M")) // m/s
+        *suffix = _T(" m/s");
+      else if (unit == _T("K")) // km/h
+        *suffix = _T(" km/h");
  ... to be completed
  */
-                else
-                  m_data = wxString::Format(m_format, data)+_T(" ")+unit;
+      else
+        *suffix = _T(" ")+unit;
+}
+
+// Values are formatted into a stack buffer, and not at all while the value
+// rounded to its last shown digit and the unit stay the same
+void OdometerInstrument_Single::SetData(int st, double data, const wxString &unit) {
+      if (m_cap_flag & st) {
+            if (!std::isnan(data) && (data < 999999)) {
+                if (!m_bHaveUnit || (unit != m_unit)) {
+                  m_unit = unit;
+                  UnitAffixes(unit, &m_prefix, &m_suffix);
+                  m_bHaveUnit = true;
+                  m_bHaveValue = false;
+                }
+                if (m_ValueFormat.IsFixed()) {
+                  long long scaled = m_ValueFormat.Scaled(data);
+                  if (m_bHaveValue && (scaled == m_Scaled)) return;
+                  m_Scaled = scaled;
+                  m_bHaveValue = true;
+
+                  char buffer[VALUE_FORMAT_BUFFER];
+                  size_t length = m_ValueFormat.Print(scaled, buffer, sizeof(buffer));
+                  m_data = m_prefix + wxString::FromAscii(buffer, length) + m_suffix;
+                  m_bDamaged = true;
+                }
+                else {
+                  wxString data_text = m_prefix + wxString::Format(m_format, data) + m_suffix;
+                  if (data_text != m_data) {
+                        m_data = data_text;
+                        m_bDamaged = true;
+                  }
+                }
             }
-            else
+            else if (m_bHaveValue || (m_data != _T("---"))) {
                 m_data = _T("---");
+                m_bHaveValue = false;
+                m_bDamaged = true;
+            }
       }
 }
 
@@ -286,42 +361,18 @@ wxSize OdometerInstrument_String::GetSize(int orient, wxSize hint) {
 }
 
 void OdometerInstrument_String::Draw(wxGCDC* dc) {
-      wxColour cl;
-#ifdef __WXMSW__
-      wxBitmap tbm(dc->GetSize().x, m_DataHeight, -1);
-      wxMemoryDC tdc(tbm);
-      wxColour c2;
-      GetGlobalColor(_T("DASHB"), &c2);
-      tdc.SetBackground(c2);
-      tdc.Clear();
-
-      tdc.SetFont(*g_pFontData);
-      GetGlobalColor(_T("DASHF"), &cl);
-      tdc.SetTextForeground(cl);
-
-      tdc.DrawText(m_data, 10, 0);
-
-      tdc.SelectObject(wxNullBitmap);
-
-      dc->DrawBitmap(tbm, 0, m_TitleHeight, false);
-#else
-      dc->SetFont(*g_pFontData);
-      GetGlobalColor(_T("DASHF"), &cl);
-      dc->SetTextForeground(cl);
-
-      dc->DrawText(m_data, 10, m_TitleHeight);
-
-#endif
-
+      DrawDataText(dc, m_data, m_DataHeight);
 }
 
-void OdometerInstrument_String::SetData(int st, double data, wxString unit) {
+void OdometerInstrument_String::SetData(int st, double data, const wxString &unit) {
     if (m_cap_flag & st) {
+        wxString previous = m_data;
         if (!std::isnan(data) && (data < 999999)) {
             m_data = wxString::Format( m_format , " " )+unit; 
         }
     else
             m_data = _T("---");
+        if (m_data != previous) m_bDamaged = true;
     }
 }
 
@@ -70,8 +70,36 @@ bool LATITUDE::IsDataValid( void )
 
 void LATITUDE::Parse( int position_field_number, int north_or_south_field_number, const SENTENCE& sentence )
 {
-   wxString n_or_s = sentence.Field( north_or_south_field_number );
-   Set( sentence.Double( position_field_number ), n_or_s );
+   if ( sentence.DecodeDouble( position_field_number, &Latitude ) != FieldValid )
+   {
+      // No usable position, IsDataValid() reports this through Northing
+      Latitude = 0.0;
+      Northing = NS_Unknown;
+      return;
+   }
+
+   // Same rule as Set(), the first non blank character decides
+   size_t length;
+   const char *n_or_s = sentence.FieldData( north_or_south_field_number, &length );
+   size_t index = 0;
+
+   while ( index < length && n_or_s[ index ] == ' ' )
+   {
+      index++;
+   }
+
+   if ( index < length && n_or_s[ index ] == 'N' )
+   {
+      Northing = North;
+   }
+   else if ( index < length && n_or_s[ index ] == 'S' )
+   {
+      Northing = South;
+   }
+   else
+   {
+      Northing = NS_Unknown;
+   }
 }
 
 void LATITUDE::Set( double position, const wxString& north_or_south )
@@ -70,8 +70,36 @@ bool LONGITUDE::IsDataValid( void )
 
 void LONGITUDE::Parse( int position_field_number, int east_or_west_field_number, const SENTENCE& sentence )
 {
-   wxString w_or_e = sentence.Field( east_or_west_field_number );
-   Set( sentence.Double( position_field_number ), w_or_e );
+   if ( sentence.DecodeDouble( position_field_number, &Longitude ) != FieldValid )
+   {
+      // No usable position, IsDataValid() reports this through Easting
+      Longitude = 0.0;
+      Easting = EW_Unknown;
+      return;
+   }
+
+   // Same rule as Set(), the first non blank character decides
+   size_t length;
+   const char *w_or_e = sentence.FieldData( east_or_west_field_number, &length );
+   size_t index = 0;
+
+   while ( index < length && w_or_e[ index ] == ' ' )
+   {
+      index++;
+   }
+
+   if ( index < length && w_or_e[ index ] == 'E' )
+   {
+      Easting = East;
+   }
+   else if ( index < length && w_or_e[ index ] == 'W' )
+   {
+      Easting = West;
+   }
+   else
+   {
+      Easting = EW_Unknown;
+   }
 }
 
 void LONGITUDE::Set( double position, const wxString& east_or_west )
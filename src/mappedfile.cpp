@@ -0,0 +1,195 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "mappedfile.h"
+
+#ifndef __WXMSW__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {
+#ifdef __WXMSW__
+    m_hFile = INVALID_HANDLE_VALUE;
+    m_hMapping = NULL;
+#else
+    m_fd = -1;
+#endif
+    m_pData = NULL;
+    m_Size = 0;
+    m_bReadOnly = false;
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const wxString &path, size_t minimumSize) {
+    Close();
+
+    size_t size;
+    if (!OpenFile(path, false, &size)) return false;
+
+    if (size < minimumSize) size = minimumSize;
+    if (!Map(size)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+// Fails for an empty file, there is nothing to map
+bool MappedFile::OpenReadOnly(const wxString &path) {
+    Close();
+
+    size_t size;
+    if (!OpenFile(path, true, &size)) return false;
+
+    if ((size == 0) || !Map(size)) {
+        Close();
+        return false;
+    }
+#ifndef __WXMSW__
+    madvise(m_pData, m_Size, MADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+bool MappedFile::OpenFile(const wxString &path, bool readOnly, size_t *size) {
+    m_bReadOnly = readOnly;
+
+#ifdef __WXMSW__
+    if (readOnly) {
+        m_hFile = CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    } else {
+        m_hFile = CreateFileW(path.wc_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    }
+    if (m_hFile == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(m_hFile, &length)) {
+        Close();
+        return false;
+    }
+    // Larger than the address space, cannot be mapped whole
+    if ((unsigned long long) length.QuadPart > (size_t) -1) {
+        Close();
+        return false;
+    }
+    *size = (size_t) length.QuadPart;
+#else
+    m_fd = readOnly ? open(path.fn_str(), O_RDONLY) : open(path.fn_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) return false;
+
+    struct stat st;
+    if ((fstat(m_fd, &st) != 0) || ((unsigned long long) st.st_size > (size_t) -1)) {
+        Close();
+        return false;
+    }
+    *size = (size_t) st.st_size;
+#endif
+    return true;
+}
+
+// Grows (or shrinks) the file, the mapping may move
+bool MappedFile::Resize(size_t size) {
+    if (!IsOpened() || m_bReadOnly) return false;
+    Sync();
+    Unmap();
+    return Map(size);
+}
+
+bool MappedFile::Map(size_t size) {
+#ifdef __WXMSW__
+    // Creating a mapping larger than the file extends it
+    m_hMapping = CreateFileMappingW(m_hFile, NULL, m_bReadOnly ? PAGE_READONLY : PAGE_READWRITE,
+        (DWORD) ((unsigned long long) size >> 32), (DWORD) (size & 0xFFFFFFFF), NULL);
+    if (m_hMapping == NULL) return false;
+
+    m_pData = MapViewOfFile(m_hMapping, m_bReadOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (m_pData == NULL) {
+        CloseHandle(m_hMapping);
+        m_hMapping = NULL;
+        return false;
+    }
+#else
+    if (!m_bReadOnly) {
+        struct stat st;
+        if ((fstat(m_fd, &st) != 0) || (((size_t) st.st_size != size) && (ftruncate(m_fd, size) != 0))) return false;
+    }
+
+    void *data = mmap(NULL, size, m_bReadOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) return false;
+    m_pData = data;
+#endif
+    m_Size = size;
+    return true;
+}
+
+void MappedFile::Unmap() {
+    if (m_pData == NULL) return;
+#ifdef __WXMSW__
+    UnmapViewOfFile(m_pData);
+    CloseHandle(m_hMapping);
+    m_hMapping = NULL;
+#else
+    munmap(m_pData, m_Size);
+#endif
+    m_pData = NULL;
+    m_Size = 0;
+}
+
+// Schedules the changed pages for writing, does not wait for the disk
+void MappedFile::Sync() {
+    if ((m_pData == NULL) || m_bReadOnly) return;
+#ifdef __WXMSW__
+    FlushViewOfFile(m_pData, 0);
+#else
+    msync(m_pData, m_Size, MS_ASYNC);
+#endif
+}
+
+void MappedFile::Close() {
+    Sync();
+    Unmap();
+#ifdef __WXMSW__
+    if (m_hFile != INVALID_HANDLE_VALUE) CloseHandle(m_hFile);
+    m_hFile = INVALID_HANDLE_VALUE;
+#else
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+#endif
+}
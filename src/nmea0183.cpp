@@ -56,6 +56,7 @@ NMEA0183::NMEA0183()
 //   response_table.Append((RESPONSE *)&Xdr);
    sort_response_table();
    set_container_pointers();
+   build_dispatch_table();
 }
 
 NMEA0183::~NMEA0183()
@@ -68,6 +69,8 @@ void NMEA0183::initialize( void)
 //   ASSERT_VALID( this);
 
    ErrorMessage.Empty();
+   LastSentenceIDCode = NMEA0183_ID_UNKNOWN;
+   preparse_state = -1;
 }
 
 void NMEA0183::set_container_pointers( void)
@@ -129,6 +132,79 @@ void NMEA0183::sort_response_table( void)
 */
 }
 
+void NMEA0183::build_dispatch_table( void)
+{
+//   ASSERT_VALID( this);
+
+   int index = 0;
+   int entries = 0;
+
+   for( index = 0; index < NMEA0183_DISPATCH_TABLE_SIZE; index++)
+   {
+      dispatch_ids[ index ] = NMEA0183_ID_UNKNOWN;
+      dispatch_table[ index ] = (RESPONSE *) NULL;
+   }
+
+   wxMRLNode *node = response_table.GetFirst();
+
+   while( node)
+   {
+      RESPONSE *resp = node->GetData();
+
+      unsigned int sentence_id = NMEA0183_ID_UNKNOWN;
+
+      if (resp->Mnemonic.Len() == 3)
+      {
+         sentence_id = NMEA0183_SENTENCE_ID( resp->Mnemonic[ 0 ], resp->Mnemonic[ 1 ], resp->Mnemonic[ 2 ]);
+      }
+      else if (resp->Mnemonic == _T("P"))
+      {
+         sentence_id = NMEA0183_ID_PROPRIETARY;
+      }
+
+      if (sentence_id != NMEA0183_ID_UNKNOWN)
+      {
+         /*
+         ** The hash is chosen to be collision free for the table above,
+         ** probe anyway so that a new sentence can never shadow another.
+         ** Probing needs at least one free slot to end the lookups.
+         */
+
+         wxASSERT( entries < NMEA0183_DISPATCH_TABLE_SIZE - 1);
+         entries++;
+
+         unsigned int slot = NMEA0183_DISPATCH_SLOT( sentence_id);
+
+         while( dispatch_table[ slot ] != NULL)
+         {
+            slot = ( slot + 1) & ( NMEA0183_DISPATCH_TABLE_SIZE - 1);
+         }
+
+         dispatch_ids[ slot ] = sentence_id;
+         dispatch_table[ slot ] = resp;
+      }
+
+      node = node->GetNext();
+   }
+}
+
+RESPONSE *NMEA0183::find_response( unsigned int sentence_id) const
+{
+   unsigned int slot = NMEA0183_DISPATCH_SLOT( sentence_id);
+
+   while( dispatch_table[ slot ] != NULL)
+   {
+      if (dispatch_ids[ slot ] == sentence_id)
+      {
+         return( dispatch_table[ slot ]);
+      }
+
+      slot = ( slot + 1) & ( NMEA0183_DISPATCH_TABLE_SIZE - 1);
+   }
+
+   return( (RESPONSE *) NULL);
+}
+
 /*
 ** Public Interface
 */
@@ -165,30 +241,56 @@ bool NMEA0183::IsGood( void) const
    return( TRUE);
 }
 
+bool NMEA0183::IsChecksumBad( void) const
+{
+//   ASSERT_VALID( this);
+
+   /*
+   ** Tells a sentence dropped for its checksum from one that did not parse
+   */
+
+   return( sentence.IsChecksumBad() == NTrue );
+}
+
 
 bool NMEA0183::PreParse( void)
 {
-    wxCharBuffer buf = sentence.Sentence.ToUTF8();
-    if (!buf.data())                            // badly formed sentence?
-        return false;
-    
+      if (preparse_state >= 0)                  // Already done for this sentence
+            return( preparse_state == 1);
+
+      preparse_state = 0;
+      LastSentenceIDCode = NMEA0183_ID_UNKNOWN;
+
       if (IsGood())
       {
-            wxString mnemonic = sentence.Field( 0);
+            size_t length;
+            const char *mnemonic = sentence.FieldData( 0, &length);
 
       /*
             ** See if this is a proprietary field
       */
 
-            if (mnemonic.Left( 1) == 'P')
-                  mnemonic = _T("P");
-
+            if (length > 0 && mnemonic[ 0 ] == 'P')
+            {
+                  LastSentenceIDCode = NMEA0183_ID_PROPRIETARY;
+                  LastSentenceIDReceived = _T("P");
+            }
+            else if (length >= 3)
+            {
+                  mnemonic += length - 3;
+                  LastSentenceIDCode = NMEA0183_SENTENCE_ID( mnemonic[ 0 ], mnemonic[ 1 ], mnemonic[ 2 ]);
+
+                  LastSentenceIDReceived.Empty();
+                  LastSentenceIDReceived += (wxChar) mnemonic[ 0 ];
+                  LastSentenceIDReceived += (wxChar) mnemonic[ 1 ];
+                  LastSentenceIDReceived += (wxChar) mnemonic[ 2 ];
+            }
             else
-                  mnemonic = mnemonic.Right( 3);
-
-
-            LastSentenceIDReceived = mnemonic;
+            {
+                  LastSentenceIDReceived.Empty();
+            }
 
+            preparse_state = 1;
             return true;
       }
       else
@@ -202,73 +304,60 @@ bool NMEA0183::Parse( void)
 
    if(PreParse())
    {
+      RESPONSE *response_p = find_response( LastSentenceIDCode);
 
-      wxString mnemonic = sentence.Field( 0);
+      if (response_p == NULL)
+      {
+         /*
+         ** Set up our error message
+         */
 
-      /*
-      ** See if this is a proprietary field
-      */
+         ErrorMessage = LastSentenceIDReceived;
+         ErrorMessage += _T(" is an unknown type of sentence");
 
-      if (mnemonic.Left( 1) == 'P')
-      {
-          mnemonic = _T("P");
-      }
-      else
-      {
-         mnemonic = mnemonic.Right( 3);
+         return( FALSE);
       }
 
+      return_value = response_p->Parse( sentence);
+
       /*
-      ** Set up our default error message
+      ** Set your ErrorMessage
       */
 
-      ErrorMessage = mnemonic;
-      ErrorMessage += _T(" is an unknown type of sentence");
-
-      LastSentenceIDReceived = mnemonic;
-
-      RESPONSE *response_p = (RESPONSE *) NULL;
-
-
-//          Traverse the response list to find a mnemonic match
-
-       wxMRLNode *node = response_table.GetFirst();
-
-       int comparison  = 0;
+      if (return_value == TRUE)
+      {
+         ErrorMessage = _T("No Error");
+         LastSentenceIDParsed = response_p->Mnemonic;
 
-        while(node)
-        {
-           RESPONSE *resp = node->GetData();
+         /*
+         ** The talker is the two characters after the $, only expand it when it changes
+         */
 
-            comparison = mnemonic.Cmp( resp->Mnemonic);
+         size_t length;
+         const char *mnemonic = sentence.FieldData( 0, &length);
+         wxChar first  = ( length >= 2) ? (wxChar) mnemonic[ 0 ] : 0;
+         wxChar second = ( length >= 2) ? (wxChar) mnemonic[ 1 ] : 0;
 
-            if (comparison == 0)
+         if (first == 0)
+         {
+            if (!TalkerID.IsEmpty())
             {
-                        response_p = (RESPONSE *) resp;
-                        return_value = response_p->Parse( sentence);
-
-                        /*
-                        ** Set your ErrorMessage
-                        */
-
-                        if (return_value == TRUE)
-                        {
-                           ErrorMessage = _T("No Error");
-                           LastSentenceIDParsed = response_p->Mnemonic;
-                           TalkerID = talker_id( sentence);
-                           ExpandedTalkerID = expand_talker_id( TalkerID);
-                        }
-                        else
-                        {
-                           ErrorMessage = response_p->ErrorMessage;
-                        }
-
-                        break;
-                   }
-
-              node = node->GetNext();
-        }
-
+               TalkerID.Empty();
+               ExpandedTalkerID = expand_talker_id( TalkerID);
+            }
+         }
+         else if (TalkerID.Len() != 2 || TalkerID[ 0 ] != first || TalkerID[ 1 ] != second)
+         {
+            TalkerID.Empty();
+            TalkerID += first;
+            TalkerID += second;
+            ExpandedTalkerID = expand_talker_id( TalkerID);
+         }
+      }
+      else
+      {
+         ErrorMessage = response_p->ErrorMessage;
+      }
    }
    else
    {
@@ -283,6 +372,7 @@ NMEA0183& NMEA0183::operator << (wxString & source)
 //   ASSERT_VALID( this);
 
    sentence = source;
+   preparse_state = -1;
 
    return( *this);
 }
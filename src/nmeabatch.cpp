@@ -0,0 +1,251 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "nmeabatch.h"
+#include "nmea0183.h"
+#include "sentencering.h"
+#include <cmath>
+#include <cstring>
+
+// A sentence split as SENTENCE::Tokenize() does, at ',' and '*' with the
+// checksum field keeping its '*'. Fields point into the log.
+struct BatchSentence {
+    const char *Data[NMEA0183_MAX_FIELDS];
+    unsigned char Length[NMEA0183_MAX_FIELDS];
+    int Fields;                 // Indexed fields, at most NMEA0183_MAX_FIELDS
+    int DataFields;             // Fields before the '*', not counting the address
+    int ChecksumField;          // Field starting with '*', -1 if none
+    unsigned char Checksum;     // Computed over the characters between '$' and '*'
+};
+
+static const char *FieldData(const BatchSentence &sentence, int field, size_t *length) {
+    if (field < 0 || field >= sentence.Fields) {
+        *length = 0;
+        return "";
+    }
+    *length = sentence.Length[field];
+    return sentence.Data[field];
+}
+
+static char FieldCharacter(const BatchSentence &sentence, int field) {
+    size_t length;
+    const char *data = FieldData(sentence, field, &length);
+    return (length == 1) ? data[0] : 0;
+}
+
+// First non blank character, as LATITUDE::Parse() and LONGITUDE::Parse() read a hemisphere
+static char Hemisphere(const BatchSentence &sentence, int field) {
+    size_t length;
+    const char *data = FieldData(sentence, field, &length);
+    size_t index = 0;
+    while (index < length && data[index] == ' ') index++;
+    return (index < length) ? data[index] : 0;
+}
+
+static void SetTalker(char *talker, const BatchSentence &sentence) {
+    size_t length;
+    const char *address = FieldData(sentence, 0, &length);
+    talker[0] = (length >= 2) ? address[0] : 0;
+    talker[1] = (length >= 2) ? address[1] : 0;
+    talker[2] = 0;
+}
+
+double NmeaDegrees(double ddmm, bool negative) {
+    double degrees = (int) (ddmm / 100.0) + fmod(ddmm, 100.0) / 60.0;
+    return negative ? -degrees : degrees;
+}
+
+NmeaBatchDecoder::NmeaBatchDecoder(NmeaBatchSink *sink) {
+    m_pSink = sink;
+    memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+// The log is split into lines with memchr(), which the C libraries we build
+// with implement with vector instructions on every platform
+void NmeaBatchDecoder::Decode(const char *data, size_t size) {
+    const char *end = data + size;
+    while (data < end) {
+        const char *eol = (const char *) memchr(data, '\n', end - data);
+        if (!eol) eol = end;
+        m_Stats.Lines++;
+        DecodeLine(data, eol);
+        data = eol + 1;
+    }
+}
+
+void NmeaBatchDecoder::DecodeLine(const char *line, const char *end) {
+    // Skip any time stamp or other prefix a logger put in front of the sentence
+    const char *start = (const char *) memchr(line, '$', end - line);
+    if (!start || memchr(line, '!', start - line)) {
+        m_Stats.Skipped++;
+        return;
+    }
+    while (end > start && end[-1] == '\r') end--;
+
+    // Same classification as OdometerWorker::Prefilter(), on the sentence as
+    // OpenCPN passes it, with CR LF
+    size_t body = end - start;
+    size_t length = body + 2;
+    if (length < 7 || start[1] == 'P') {
+        m_Stats.Skipped++;
+        return;
+    }
+    size_t comma = 6;
+    if (body <= 6 || start[6] != ',') {
+        for (comma = 4; comma < 9 && comma < body; comma++) {
+            if (start[comma] == ',') break;
+        }
+        if (comma >= 9 || comma >= body) {
+            m_Stats.Skipped++;
+            return;
+        }
+    }
+    unsigned int id = NMEA0183_SENTENCE_ID(start[comma - 3], start[comma - 2], start[comma - 1]);
+    if ((id != NMEA0183_ID_GGA) && (id != NMEA0183_ID_RMC)) {
+        m_Stats.Skipped++;
+        return;
+    }
+    if (length >= RAW_SENTENCE_LENGTH) {
+        m_Stats.TooLong++;
+        return;
+    }
+
+    // One pass splits the fields and computes the checksum, SENTENCE stops at the first CR
+    const char *stop = (const char *) memchr(start, '\r', body);
+    if (!stop) stop = end;
+
+    BatchSentence sentence;
+    sentence.Fields = 0;
+    sentence.DataFields = 0;
+    sentence.ChecksumField = -1;
+    unsigned char checksum = 0;
+    bool checksumSeen = false;
+    const char *field = start + 1;
+
+    for (const char *p = start + 1; ; p++) {
+        char c = (p < stop) ? *p : ',';
+        if ((p == stop) || (c == ',') || (c == '*')) {
+            if (sentence.Fields < NMEA0183_MAX_FIELDS) {
+                sentence.Data[sentence.Fields] = field;
+                sentence.Length[sentence.Fields] = (unsigned char) (p - field);
+            }
+            sentence.Fields++;
+            if (!checksumSeen) sentence.DataFields = sentence.Fields - 1;
+            if (p == stop) break;
+
+            if (c == '*') {
+                if (!checksumSeen && sentence.Fields < NMEA0183_MAX_FIELDS) sentence.ChecksumField = sentence.Fields;
+                checksumSeen = true;
+                field = p;
+            } else {
+                field = p + 1;
+            }
+        }
+        // As queued by Submit(), anything but 7 bit ASCII is a '?'
+        if (!checksumSeen) checksum ^= ((c != 0) && ((unsigned char) c < 0x80)) ? c : '?';
+    }
+    if (sentence.Fields > NMEA0183_MAX_FIELDS) sentence.Fields = NMEA0183_MAX_FIELDS;
+    sentence.Checksum = checksum;
+
+    // NMEA0183::PreParse() takes the mnemonic from the address field as split above
+    size_t addressLength;
+    const char *address = FieldData(sentence, 0, &addressLength);
+    if (addressLength < 3 || address[0] == 'P' ||
+        NMEA0183_SENTENCE_ID(address[addressLength - 3], address[addressLength - 2], address[addressLength - 1]) != id) {
+        m_Stats.Skipped++;
+        return;
+    }
+
+    // Checked before any field is converted, as RMC::Parse() and GGA::Parse() do
+    size_t fieldLength;
+    const char *fieldData;
+    if (sentence.ChecksumField >= 0) {
+        fieldData = FieldData(sentence, sentence.ChecksumField, &fieldLength);
+        if (ChecksumValue(fieldData, fieldLength) != sentence.Checksum) {
+            m_Stats.BadChecksums++;
+            return;
+        }
+    }
+
+    if (id == NMEA0183_ID_GGA) {
+        // GGA::Parse()
+        NmeaGGARecord gga;
+        SetTalker(gga.Talker, sentence);
+        fieldData = FieldData(sentence, 7, &fieldLength);
+        if (IntegerValue(fieldData, fieldLength, &gga.SatsInUse) != FieldValid) gga.SatsInUse = 0;
+        fieldData = FieldData(sentence, 8, &fieldLength);
+        if (DecimalValue(fieldData, fieldLength, &gga.HDOPlevel) != FieldValid) gga.HDOPlevel = 99.99;
+
+        m_Stats.GGA++;
+        m_pSink->OnGGA(gga);
+        return;
+    }
+
+    // RMC::Parse()
+    int last = sentence.DataFields;
+    NmeaRMCRecord rmc;
+    SetTalker(rmc.Talker, sentence);
+
+    // A 2.3 mode of N or S means the data is not valid
+    char mode = FieldCharacter(sentence, last);
+    fieldData = FieldData(sentence, 2, &fieldLength);
+    rmc.DataValid = (fieldLength > 0) && (fieldData[0] == 'A') && (mode != 'N') && (mode != 'S');
+
+    fieldData = FieldData(sentence, 1, &fieldLength);
+    if (TimeOfDayValue(fieldData, fieldLength, &rmc.SecondsOfDay) != FieldValid) rmc.SecondsOfDay = -1.0;
+
+    double latitude;
+    double longitude;
+    char northing = Hemisphere(sentence, 4);
+    char easting = Hemisphere(sentence, 6);
+    fieldData = FieldData(sentence, 3, &fieldLength);
+    bool haveLatitude = (DecimalValue(fieldData, fieldLength, &latitude) == FieldValid) &&
+        ((northing == 'N') || (northing == 'S'));
+    fieldData = FieldData(sentence, 5, &fieldLength);
+    bool haveLongitude = (DecimalValue(fieldData, fieldLength, &longitude) == FieldValid) &&
+        ((easting == 'E') || (easting == 'W'));
+    rmc.HavePosition = haveLatitude && haveLongitude;
+    rmc.Latitude = rmc.HavePosition ? NmeaDegrees(latitude, northing == 'S') : 0.0;
+    rmc.Longitude = rmc.HavePosition ? NmeaDegrees(longitude, easting == 'W') : 0.0;
+
+    fieldData = FieldData(sentence, 7, &fieldLength);
+    if (DecimalValue(fieldData, fieldLength, &rmc.Speed) != FieldValid) {
+        rmc.Speed = 0.0;
+        rmc.DataValid = false;
+    }
+
+    fieldData = FieldData(sentence, 9, &fieldLength);
+    if (DateValue(fieldData, fieldLength, &rmc.DayNumber) != FieldValid) rmc.DayNumber = -1;
+
+    m_Stats.RMC++;
+    m_pSink->OnRMC(rmc);
+}
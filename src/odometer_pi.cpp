@@ -51,6 +51,7 @@ wxFont *g_pFontTitle;
 wxFont *g_pFontData;
 wxFont *g_pFontLabel;
 wxFont *g_pFontSmall;
+OdometerGlyphCache *g_pGlyphsData;
 
 
 // Preferences, Units and Values
@@ -59,9 +60,13 @@ int       g_iShowDepArrTimes = 1;
 int       g_iShowTripLeg = 1;
 int       g_iOdoSpeedMax;
 int       g_iOdoOnRoute;
+int       g_iOdoDisplayFPS = 1;
+int       g_iOdoWatchdogPeriods = WATCHDOG_DEFAULT_PERIODS;
 int       g_iOdoUTCOffset;
 int       g_iOdoSpeedUnit;
 int       g_iOdoDistanceUnit;
+int       g_iOdoDistanceEngine;
+bool      g_bOdoEllipsoid;
 int       g_iResetTrip = 0; 
 int       g_iStartStopLeg = 0;
 int       g_iResetLeg = 0;
@@ -72,6 +77,10 @@ int       g_iResetLeg = 0;
 // BUG BUG Zeroing instruments not yet implemented
 wxDateTime watchDogTime;
 
+// Instrument channels fed by Odometer(), all are rebuilt when the units may have changed
+#define ODOMETER_OUTPUT_CHANNELS (OCPN_DBP_STC_SOG | OCPN_DBP_STC_SUMLOG | OCPN_DBP_STC_TRIPLOG | \
+    OCPN_DBP_STC_DEPART | OCPN_DBP_STC_ARRIV | OCPN_DBP_STC_LEGDIST | OCPN_DBP_STC_LEGTIME)
+
 #if !defined(NAN)
 static const long long lNaN = 0xfff8000000000000;
 #define NAN (*(double*)&lNaN)
@@ -159,6 +168,23 @@ wxString MakeName() {
     return _T("ODOMETER");
 }
 
+// Departure and arrival times are saved as local time text, "---" when not set
+static OdometerTime ParseOdometerTime(const wxString &text) {
+    wxDateTime time;
+    if (!time.ParseDateTime(text)) return ODOMETER_NO_TIME;
+    return time.GetValue().GetValue();
+}
+
+static wxString FormatOdometerTime(OdometerTime time, const wxString &format, const wxString &none) {
+    if (time == ODOMETER_NO_TIME) return none;
+    return wxDateTime(wxLongLong(time)).Format(format);
+}
+
+OdometerTime OdometerLocalClock::Now() {
+    wxTimeSpan offset(0, (g_iOdoUTCOffset - 24) * 30, 0);
+    return wxDateTime::Now().Add(offset).GetValue().GetValue();
+}
+
 //---------------------------------------------------------------------------------------------------------
 //
 //          PlugIn initialization and de-init
@@ -168,6 +194,9 @@ wxString MakeName() {
 odometer_pi::odometer_pi(void *ppimgr) : opencpn_plugin_116(ppimgr), wxTimer(this) {
     // Create the PlugIn icons
     initialize_images();
+    m_pWorker = NULL;
+    m_pEngine = NULL;
+    m_DirtyChannels = 0;
 }
 
 // Odometer Destructor
@@ -187,6 +216,7 @@ int odometer_pi::Init(void) {
     g_pFontData = new wxFont(11, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
     g_pFontLabel = new wxFont(11, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
     g_pFontSmall = new wxFont(8, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
+    g_pGlyphsData = new OdometerGlyphCache();
 
     // Wire up the OnClose AUI event
     m_pauimgr = GetFrameAuiManager();
@@ -198,6 +228,45 @@ int odometer_pi::Init(void) {
     // And load the configuration items
     LoadConfig();
 
+    // Start the NMEA parsing thread, the instruments read its snapshot on each timer tick
+    m_Snapshot = OdometerSnapshot();
+    m_LastFixSequence = 0;
+    m_LastDistance = 0.0;
+    m_bSOGValid = false;
+    m_pWorker = new OdometerWorker();
+    m_pWorker->SetGates(atoi(m_SatsInUse), atoi(m_HDOPdefine), atoi(m_PwrOnDelSecs));
+    m_pWorker->SetDistanceEngine(g_iOdoDistanceEngine, g_bOdoEllipsoid);
+    m_pWorker->SetWatchdogPeriods(g_iOdoWatchdogPeriods);
+
+    // The trip journal survives crashes, prefer its distances over the saved configuration
+    wxString journalDir = *GetpPrivateApplicationDataLocation() + wxFileName::GetPathSeparator() + _T("plugins") +
+        wxFileName::GetPathSeparator() + _T("gpsodometer_pi");
+    if (!wxDirExists(journalDir)) wxFileName::Mkdir(journalDir, 0755, wxPATH_MKDIR_FULL);
+
+    UpdateDistanceUnit();
+    double total = 0.0, trip = 0.0;
+    m_TotDist.ToDouble(&total);
+    m_TripDist.ToDouble(&trip);
+    total = total * DistDiv / 3600.0;
+    trip = trip * DistDiv / 3600.0;
+    if (!m_pWorker->OpenJournal(journalDir + wxFileName::GetPathSeparator() + _T("triplog.dat"), &total, &trip)) {
+        wxLogMessage(_T("GPS Odometer: Unable to open the trip journal in %s"), journalDir.c_str());
+    }
+
+    // Continue the trip where it was left, the first start departs and arrives now
+    m_pEngine = new OdometerEngine(&m_Clock);
+    OdometerTime departure = ParseOdometerTime(m_DepTime);
+    OdometerTime arrival = ParseOdometerTime(m_ArrTime);
+    if (m_DepTime == "2020-01-01 00:00:00") {
+        departure = m_Clock.Now();
+        arrival = departure;
+    }
+    m_pEngine->Restore(total, trip, departure, arrival);
+
+    if (m_pWorker->Run() != wxTHREAD_NO_ERROR) {
+        wxLogMessage(_T("GPS Odometer: Unable to start the NMEA worker thread"));
+    }
+
     // Scaleable Vector Graphics (SVG) icons are stored in the following path.
     wxString iconFolder = GetPluginDataDir("gpsodometer_pi") + wxFileName::GetPathSeparator() + _T("data") + wxFileName::GetPathSeparator();
 
@@ -226,8 +295,8 @@ int odometer_pi::Init(void) {
         SaveConfig();
     }
 
-    // Initialize the watchdog timer
-    Start(1000, wxTIMER_CONTINUOUS);
+    // Initialize the display timer, it also drives the leg time
+    Start(1000 / g_iOdoDisplayFPS, wxTIMER_CONTINUOUS);
 
     // Reduced from the original odometer requests
     return (WANTS_TOOLBAR_CALLBACK | INSTALLS_TOOLBAR_TOOL | WANTS_PREFERENCES | WANTS_CONFIG | WANTS_NMEA_SENTENCES | USES_AUI_MANAGER);
@@ -242,6 +311,32 @@ bool odometer_pi::DeInit(void) {
 	Stop(); 
     }
 
+    // Join the NMEA parsing thread before its queue goes away
+    if (m_pWorker) {
+        m_pWorker->Stop();
+        if (m_pWorker->IsRunning()) m_pWorker->Wait();
+
+        OdometerFilterStats stats = m_pWorker->GetFilterStats();
+        wxLogMessage(_T("GPS Odometer: %lu sentences used, rejected %lu AIS, %lu proprietary, %lu non NMEA, %lu unused, %lu too long, %lu overruns"),
+            stats.Accepted, stats.Rejected[REJECT_AIS], stats.Rejected[REJECT_PROPRIETARY],
+            stats.Rejected[REJECT_NOT_NMEA], stats.Rejected[REJECT_UNCONSUMED],
+            stats.Rejected[REJECT_TOO_LONG], stats.Rejected[REJECT_OVERRUN]);
+        wxLogMessage(_T("GPS Odometer: integrated source %s, %lu source switches, %lu standby fixes"),
+            wxString::FromAscii(m_Snapshot.Source).c_str(), m_Snapshot.SourceSwitches, m_Snapshot.SecondaryFixes);
+        OdometerSentenceStats sentenceStats;
+        m_pWorker->GetSentenceStats(&sentenceStats);
+        wxLogMessage(_T("GPS Odometer: sentences\n%s"),
+            sentenceStats.Report(wxGetLocalTimeMillis().GetValue()).c_str());
+        delete m_pWorker;
+        m_pWorker = NULL;
+    }
+    delete m_pEngine;
+    m_pEngine = NULL;
+
+#ifdef ODOMETER_PROFILE
+    wxLogMessage(_T("GPS Odometer: latencies\n%s"), OdometerProfile::Get().Report().c_str());
+#endif
+
     // This appears to close each odometer instance
     OdometerWindow *odometer_window = m_ArrayOfOdometerWindow.Item(0)->m_pOdometerWindow;
     if (odometer_window) {
@@ -260,30 +355,38 @@ bool odometer_pi::DeInit(void) {
     delete g_pFontData;
     delete g_pFontLabel;
     delete g_pFontSmall;
+    delete g_pGlyphsData;
     return true;
 }
 
 // Called for each timer tick, refreshes each display
 void odometer_pi::Notify()
 {
-    // Force a repaint of each instrument panel
+    if (m_pWorker && m_pEngine) UpdateChannels();
+
+    // Let the instruments take what changed, only those whose display changed are repainted
     OdometerWindow *odometer_window = m_ArrayOfOdometerWindow.Item(0)->m_pOdometerWindow;
-	if (odometer_window) {
-	    odometer_window->Refresh();
-	}
+	if (odometer_window) odometer_window->PullChannels(m_Bus);
+}
 
-    //  Manage the watchdogs, watch messages used
-    mGGA_Watchdog--;
-    if( mGGA_Watchdog <= 0 ) {
-        SatsInUse = 0;
-        HDOPlevel = 100.0;
-        mGGA_Watchdog = gps_watchdog_timeout_ticks;
-    }
+// Runs the odometer on the worker's latest state and publishes the result
+void odometer_pi::UpdateChannels() {
+    // Pick up the latest state published by the worker, the watchdogs run there
+    m_Snapshot = m_pWorker->GetSnapshot();
 
-    mRMC_Watchdog--;
-    if( mRMC_Watchdog <= 0 ) {
-        SendSentenceToAllInstruments( OCPN_DBP_STC_SOG, NAN, _T("-") );
-        mRMC_Watchdog = gps_watchdog_timeout_ticks;
+    bool newFix = (m_Snapshot.FixSequence != m_LastFixSequence);
+    if ((m_Snapshot.SpeedValid != m_bSOGValid) || (m_Snapshot.SpeedValid && newFix)) {
+        m_DirtyChannels |= OCPN_DBP_STC_SOG;
+    }
+    m_bSOGValid = m_Snapshot.SpeedValid;
+    m_LastFixSequence = m_Snapshot.FixSequence;
+
+    // Only run the odometer when one of its inputs has changed, a running leg
+    // counter needs its time updated every tick
+    if (newFix || (m_Snapshot.Distance != m_LastDistance) || m_pEngine->GetState().LegRunning ||
+        (g_iResetTrip == 1) || (g_iResetLeg == 1) || (g_iStartStopLeg == 1) ||
+        (m_DirtyChannels != 0)) {
+        Odometer(newFix);
     }
 }
 
@@ -321,216 +424,105 @@ wxBitmap *odometer_pi::GetPlugInBitmap() {
     return _img_odometer_colour; 
 }
 
-// Sends the data value from the parsed NMEA sentence to each gauge
-void odometer_pi::SendSentenceToAllInstruments(int st, double value, wxString unit) {
-    OdometerWindow *odometer_window = m_ArrayOfOdometerWindow.Item(0)->m_pOdometerWindow;
-	if (odometer_window) {
-	    odometer_window->SendSentenceToAllInstruments(st, value, unit);
-	}
-}
-
 // This method is invoked by OpenCPN when we specify WANTS_NMEA_SENTENCES
+// Only queues the sentence, parsing and integration run on the worker thread
 void odometer_pi::SetNMEASentence(wxString &sentence) 
 {
-    m_NMEA0183 << sentence;
-
-    if (m_NMEA0183.PreParse()) {
-        if( m_NMEA0183.LastSentenceIDReceived == _T("GGA") ) {
-            if( m_NMEA0183.Parse() ) {
-                SatsInUse = m_NMEA0183.Gga.NumberOfSatellitesInUse;
-                HDOPlevel = m_NMEA0183.Gga.HorizontalDilutionOfPrecision;
-                mGGA_Watchdog = gps_watchdog_timeout_ticks;
-            }
-        }
-
-        else if (m_NMEA0183.LastSentenceIDReceived == _T("RMC")) {
-            if (m_NMEA0183.Parse() ) {
-                if (m_NMEA0183.Rmc.IsDataValid == NTrue) {
-
-                    // Data verification
-                    validGPS = 0;
-                    int SatsUsed = atoi(m_SatsInUse);
-                    if (SatsUsed <= 4) SatsUsed == 4;  // No less that 4 satellites
-
-                    int HDOPdefine = atoi(m_HDOPdefine);
-                    if (HDOPdefine <= 1) HDOPdefine == 1;  // HDOP between 1 and 10 
-                    if (HDOPdefine >= 10) HDOPdefine == 10;
-
-                    if ((SatsInUse >= SatsUsed) && (HDOPlevel <= HDOPdefine)) {
-                        validGPS = 1;
-                        CurrSpeed = m_NMEA0183.Rmc.SpeedOverGroundKnots;
-
-                        // Use filtered speed for the instrument
-                        // TODO: Speed is not filtered, why? iirfilter incorrectly called?
-                        SendSentenceToAllInstruments( OCPN_DBP_STC_SOG, 
-                            toUsrSpeed_Plugin (mSOGFilter.filter(CurrSpeed), g_iOdoSpeedUnit ),
-                            getUsrSpeedUnit_Plugin( g_iOdoSpeedUnit ) );
-
-                        // Date and time are wxStrings, instruments use double
-                        dt = m_NMEA0183.Rmc.Date + m_NMEA0183.Rmc.UTCTime;
-                        mUTCDateTime.ParseFormat( dt.c_str(), _T("%d%m%y%H%M%S") );
-                        mRMC_Watchdog = gps_watchdog_timeout_ticks;
-                    }
-                }
-            }
-        } 
-    }
-    if (validGPS == 0) FilteredSpeed = 0.0;
-    Odometer(); 
+    if (m_pWorker) m_pWorker->Submit(sentence);
 }
 
-void odometer_pi::Odometer() {
-
-    //  Adjust time to local time zone used by departure and arrival times
-    UTCTime = wxDateTime::Now();
-    double offset = ((g_iOdoUTCOffset-24)*30); 
-    wxTimeSpan TimeOffset(0, offset,0);
-    LocalTime = UTCTime.Add(TimeOffset);
-
-    // First time start
-    if (m_DepTime == "2020-01-01 00:00:00") {
-        m_DepTime = LocalTime.Format(wxT("%F %T"));
-        m_ArrTime = LocalTime.Format(wxT("%F %T"));
-    }
+// Feeds the worker's fixes and the instrument buttons to the engine and
+// rebuilds the instrument strings for whatever it reports as changed
+void odometer_pi::Odometer(bool newFix) {
+    ODOMETER_PROFILE_SCOPE(PROFILE_ODOMETER);
 
     /* TODO: There must be a better way to receive the reset event from
              'OdometerInstrument_Button' but using a global variable for transfer.  */
     if (g_iResetTrip == 1) {                             
-        SetDepTime = 1;
-        UseSavedDepTime = 0;
-        UseSavedArrTime = 0;
-        UseSavedTrip = 0;
-        DepTimeShow = 0;
-        m_DepTime = "---"; 
-        m_ArrTime = "---";
-        TripDist = 0.0;
-        m_TripDist << TripDist;
+        m_pEngine->ResetTrip();
+        if (m_pWorker) m_pWorker->ResetTrip();
         // SaveConfig();              // TODO BUG: Does not save config file
         g_iResetTrip = 0;
     } 
 
     if (g_iResetLeg == 1) {  
-        LegDist = 0.0; 
-        LegTime = 0;
-        m_LegDist << LegDist;
-        m_LegTime = "---";
-        LegStart = LocalTime; 
+        m_pEngine->ResetLeg();
         // SaveConfig();              // TODO BUG: Does not save config file
         g_iResetLeg = 0;
     } 
 
-    // Set departure time to local time if CurrSpeed is greater than or equal to OnRouteSpeed
-    m_OnRouteSpeed = g_iOdoOnRoute;
-    // Reset after arrival, before system shutdown
-    if ((CurrSpeed >= m_OnRouteSpeed) && m_DepTime == "---" )  { 
-        m_DepTime = LocalTime.Format(wxT("%F %T"));
-    }
-
-    // Reset after power up, before trip start
-    if ((CurrSpeed >= m_OnRouteSpeed) && SetDepTime == 1 )  {   
-        m_DepTime = LocalTime.Format(wxT("%F %T"));
-        SetDepTime = 0;
-    }
-
-    // Select departure time to use and enable if speed is enough
-    if (CurrSpeed >= m_OnRouteSpeed && DepTimeShow == 0 )  {
-        if (UseSavedDepTime == 0) {
-            DepTime = LocalTime; 
-        } else {
-            DepTime.ParseDateTime(m_DepTime); 
-        }
-        DepTimeShow = 1;
-        strDep = DepTime.Format(wxT("%F %R"));
-    } else {
-        if (DepTimeShow == 0) strDep = " --- ";
-        if (UseSavedDepTime == 1) strDep = m_DepTime.Truncate(16);  // Cut seconds
-    }
-    SendSentenceToAllInstruments(OCPN_DBP_STC_DEPART, ' ' , strDep );
-
-    // Set and display arrival time 
-    if (DepTimeShow == 1 )  {
-        if (CurrSpeed >= m_OnRouteSpeed) {
-            strArr = _("On Route");
-            ArrTimeShow = 0;
-            UseSavedArrTime = 0;
-        } else {
-            if (ArrTimeShow == 0 ) { 
-                m_ArrTime = LocalTime.Format(wxT("%F %T")); 
-                ArrTime = LocalTime;
-                ArrTimeShow = 1;
-                strArr = ArrTime.Format(wxT("%F %R")); 
-            }
-        }
-    } else {
-        strArr = " --- ";  
-    } 
-    if (UseSavedArrTime == 1 ) strArr = m_ArrTime.Truncate(16);  // Cut seconds
-    SendSentenceToAllInstruments(OCPN_DBP_STC_ARRIV, ' ' , strArr );
-
-    // Distances
-    if (UseSavedTrip == 1) {
-        TotDist = 0.0;
-        m_TotDist.ToDouble( &TotDist );
-        TripDist = 0.0;
-        m_TripDist.ToDouble( &TripDist );
-        UseSavedTrip = 0;
-    }
-
-    GetDistance();
-
-    // Need not save full double or spaces
-    TotDist = (TotDist + StepDist); 
-    m_TotDist = " ";
-    m_TotDist.Printf("%.1f",TotDist);
-    m_TotDist.Trim(0);
-    m_TotDist.Trim(1);
-
-    TripDist = (TripDist + StepDist);
-    m_TripDist = " ";
-    m_TripDist.Printf("%.1f",TripDist);
-    m_TripDist.Trim(0);
-    m_TripDist.Trim(1);
-
     // Toggle leg counter
     if (g_iStartStopLeg == 1) {
-        if (CountLeg == 1) {
-            CountLeg = 0;  // Counter paused
-        } else {
-            CountLeg = 1;
-        }
+        m_pEngine->StartStopLeg();
         g_iStartStopLeg = 0;
     }
 
-    if (g_iShowTripLeg != 1) {   // stop to avoid overcount
-        LegDist = 0.0; 
-        LegStart = LocalTime; 
+    m_pEngine->SetOnRouteSpeed(g_iOdoOnRoute);
+    m_pEngine->SetLegEnabled(g_iShowTripLeg == 1);   // stop to avoid overcount
+
+    // The worker integrates nautical miles, pass on the part not yet counted
+    if (newFix || (m_Snapshot.Distance != m_LastDistance)) {
+        OdometerEngineFix fix;
+        fix.Speed = m_Snapshot.CurrSpeed;
+        fix.Distance = m_Snapshot.Distance - m_LastDistance;
+        m_LastDistance = m_Snapshot.Distance;
+        m_pEngine->OnFix(fix);
     }
+    m_pEngine->Tick();
 
-    // Count leg distance and time
-    if (CountLeg == 1) {
-        LegDist = (LegDist + StepDist);
-        LegTime = LocalTime.Subtract(LegStart); 
-    } else {
-        LegStart = LocalTime.Subtract(LegTime);
+    int changes = m_pEngine->TakeChanges();
+    wxString prevDistUnit = DistUnit;
+    UpdateDistanceUnit();
+    if (DistUnit != prevDistUnit) {
+        changes |= ODOMETER_CHANGED_TOTAL | ODOMETER_CHANGED_TRIP | ODOMETER_CHANGED_LEG_DIST;
     }
 
-    m_LegDist = " ";
-    m_LegDist.Printf("%.2f",LegDist);
-    m_LegDist.Trim(0);
-    m_LegDist.Trim(1);
+    const OdometerEngineState &state = m_pEngine->GetState();
+    if (changes & ODOMETER_CHANGED_TOTAL) m_DirtyChannels |= OCPN_DBP_STC_SUMLOG;
+    if (changes & ODOMETER_CHANGED_TRIP) m_DirtyChannels |= OCPN_DBP_STC_TRIPLOG;
+    if (changes & ODOMETER_CHANGED_LEG_DIST) m_DirtyChannels |= OCPN_DBP_STC_LEGDIST;
+    if (changes & ODOMETER_CHANGED_DEPARTURE) m_DirtyChannels |= OCPN_DBP_STC_DEPART;
+    if (changes & ODOMETER_CHANGED_ARRIVAL) m_DirtyChannels |= OCPN_DBP_STC_ARRIV;
+    if (changes & ODOMETER_CHANGED_LEG_TIME) m_DirtyChannels |= OCPN_DBP_STC_LEGTIME;
 
-    m_LegTime = LegTime.Format("%H:%M:%S");
-    wxString strLegTime;
-    strLegTime = LegTime.Format("%H:%M:%S"); 
+    if (m_DirtyChannels & OCPN_DBP_STC_DEPART) {
+        strDep = FormatOdometerTime(state.DepartureTime, wxT("%F %R"), " --- ");
+    }
+    if (m_DirtyChannels & OCPN_DBP_STC_ARRIV) {
+        strArr = state.OnRoute ? _("On Route") : FormatOdometerTime(state.ArrivalTime, wxT("%F %R"), " --- ");
+    }
+    if (m_DirtyChannels & OCPN_DBP_STC_LEGTIME) {
+        strLegTime = wxTimeSpan::Milliseconds(state.LegTime).Format("%H:%M:%S"); 
+    }
 
+    PublishDirtyChannels();
+}
 
-    SendSentenceToAllInstruments(OCPN_DBP_STC_SUMLOG, TotDist , DistUnit );
-    SendSentenceToAllInstruments(OCPN_DBP_STC_TRIPLOG, TripDist , DistUnit );
-    SendSentenceToAllInstruments(OCPN_DBP_STC_LEGDIST, LegDist , DistUnit );
-    SendSentenceToAllInstruments(OCPN_DBP_STC_LEGTIME, ' ' , strLegTime );  
+// Publishes only the instrument values that changed since the last update
+void odometer_pi::PublishDirtyChannels() {
+    const OdometerEngineState &state = m_pEngine->GetState();
+    double distFactor = 3600.0 / DistDiv;
+
+    if (m_DirtyChannels & OCPN_DBP_STC_SOG) {
+        if (m_bSOGValid) {
+            // Use filtered speed for the instrument
+            m_Bus.Publish( OCPN_DBP_STC_SOG, 
+                toUsrSpeed_Plugin (m_Snapshot.FilteredSpeed, g_iOdoSpeedUnit ),
+                getUsrSpeedUnit_Plugin( g_iOdoSpeedUnit ) );
+        } else {
+            m_Bus.Publish( OCPN_DBP_STC_SOG, NAN, _T("-") );
+        }
+    }
+    if (m_DirtyChannels & OCPN_DBP_STC_DEPART) m_Bus.Publish(OCPN_DBP_STC_DEPART, ' ' , strDep );
+    if (m_DirtyChannels & OCPN_DBP_STC_ARRIV) m_Bus.Publish(OCPN_DBP_STC_ARRIV, ' ' , strArr );
+    if (m_DirtyChannels & OCPN_DBP_STC_SUMLOG) m_Bus.Publish(OCPN_DBP_STC_SUMLOG, state.TotalDistance * distFactor , DistUnit );
+    if (m_DirtyChannels & OCPN_DBP_STC_TRIPLOG) m_Bus.Publish(OCPN_DBP_STC_TRIPLOG, state.TripDistance * distFactor , DistUnit );
+    if (m_DirtyChannels & OCPN_DBP_STC_LEGDIST) m_Bus.Publish(OCPN_DBP_STC_LEGDIST, state.LegDistance * distFactor , DistUnit );
+    if (m_DirtyChannels & OCPN_DBP_STC_LEGTIME) m_Bus.Publish(OCPN_DBP_STC_LEGTIME, ' ' , strLegTime );  
+    m_DirtyChannels = 0;
 }
 
-void odometer_pi::GetDistance() {
+void odometer_pi::UpdateDistanceUnit() {
 
     switch (g_iOdoDistanceUnit) {
         case 0:
@@ -546,36 +538,6 @@ void odometer_pi::GetDistance() {
             DistUnit = "km";
             break;
     }
-
-    CurrSec = wxAtoi(LocalTime.Format(wxT("%S")));
-
-    // Calculate distance travelled during the elapsed time
-
-    StepDist = 0.0;
-    if (CurrSec != PrevSec) { 
-        if (CurrSec > PrevSec) { 
-            SecDiff = (CurrSec - PrevSec);
-        } else {  
-            PrevSec = (PrevSec - 58);  // Is this always ok no matter GPS update rates?
-        }
-        StepDist = (SecDiff * (CurrSpeed/DistDiv));
-
-        /*  Are at start randomly getting extreme values for distance even if validGPS is ok.
-            Delay a minimum of 15 seconds at power up to allow everything to be properly set 
-            before measuring distances */ 
-        if (StartDelay == 1) {
-           int PwrOnDelaySecs = atoi(m_PwrOnDelSecs);
-           if (PwrOnDelaySecs <= 14) PwrOnDelaySecs = 15;
-           wxTimeSpan PwrOnDelay(0,0,PwrOnDelaySecs);
-           EnabledTime = LocalTime.Add(PwrOnDelay);
-           StartDelay = 0;
-        }
-        if (LocalTime <= EnabledTime) StepDist = 0.0;
-
-        // No distances accepted if validGPS equals 0
-        if (validGPS == 0) StepDist = 0.0;
-    }
-    PrevSec = CurrSec;
 }
 
 
@@ -591,7 +553,13 @@ int odometer_pi::GetToolbarToolCount(void) {
 //---------------------------------------------------------------------------------------------------------
 
 void odometer_pi::ShowPreferencesDialog(wxWindow* parent) {
-	OdometerPreferencesDialog *dialog = new OdometerPreferencesDialog(parent, wxID_ANY, m_ArrayOfOdometerWindow);
+	TripHistorySummary history;
+	bool haveHistory = m_pWorker && m_pWorker->GetHistory(&history);
+	OdometerSentenceStats sentenceStats;
+	if (m_pWorker) m_pWorker->GetSentenceStats(&sentenceStats);
+	UpdateDistanceUnit();
+	OdometerPreferencesDialog *dialog = new OdometerPreferencesDialog(parent, wxID_ANY, m_ArrayOfOdometerWindow,
+		haveHistory ? &history : NULL, m_pWorker ? &sentenceStats : NULL, DistDiv, DistUnit);
 
 	if (dialog->ShowModal() == wxID_OK) {
 		// Reload the fonts in case they have been changed
@@ -633,6 +601,7 @@ void odometer_pi::ShowPreferencesDialog(wxWindow* parent) {
         // Reload instruments and select panel
         OdometerWindowContainer *cont = m_ArrayOfOdometerWindow.Item(0);
         cont->m_pOdometerWindow->SetInstrumentList(cont->m_aInstrumentList);
+        m_DirtyChannels = ODOMETER_OUTPUT_CHANNELS;
         OdometerWindow *d_w = cont->m_pOdometerWindow;
         wxAuiPaneInfo &pane = m_pauimgr->GetPane(d_w);
 
@@ -663,6 +632,9 @@ void odometer_pi::ShowPreferencesDialog(wxWindow* parent) {
 
 		ApplyConfig();
 		SaveConfig();   // TODO BUG: Does not save configuration file
+		if (m_pWorker) m_pWorker->SetDistanceEngine(g_iOdoDistanceEngine, g_bOdoEllipsoid);
+		if (m_pWorker) m_pWorker->SetWatchdogPeriods(g_iOdoWatchdogPeriods);
+		if (GetInterval() != 1000 / g_iOdoDisplayFPS) Start(1000 / g_iOdoDisplayFPS, wxTIMER_CONTINUOUS);
 
 		// Not exactly sure what this does. Pesumably if no odometers are displayed, the 
         // toolbar icon is toggled/untoggled??
@@ -856,9 +828,15 @@ bool odometer_pi::LoadConfig(void) {
 
         pConf->Read(_T("SpeedometerMax"), &g_iOdoSpeedMax, 12);
         pConf->Read(_T("OnRouteSpeedLimit"), &g_iOdoOnRoute, 2);
+        pConf->Read(_T("DisplayFPS"), &g_iOdoDisplayFPS, 1);
+        g_iOdoDisplayFPS = wxMax(1, wxMin(g_iOdoDisplayFPS, 10));
+        pConf->Read(_T("WatchdogPeriods"), &g_iOdoWatchdogPeriods, WATCHDOG_DEFAULT_PERIODS);
+        g_iOdoWatchdogPeriods = wxMax(WATCHDOG_MINIMUM_PERIODS, wxMin(g_iOdoWatchdogPeriods, WATCHDOG_MAXIMUM_PERIODS));
         pConf->Read(_T("UTCOffset"), &g_iOdoUTCOffset, 24 );
         pConf->Read(_T("SpeedUnit"), &g_iOdoSpeedUnit, SPEED_KNOTS);
         pConf->Read(_T("DistanceUnit"), &g_iOdoDistanceUnit, DISTANCE_NAUTICAL_MILES);
+        pConf->Read(_T("DistanceEngine"), &g_iOdoDistanceEngine, DISTANCE_ENGINE_SOG);
+        pConf->Read(_T("EllipsoidDistance"), &g_bOdoEllipsoid, false);
 
         // Set the total number of available instruments
         int d_cnt = 10; 
@@ -964,6 +942,16 @@ bool odometer_pi::SaveConfig(void) {
         pConf->Write(_T("FontLabel"), g_pFontLabel->GetNativeFontInfoDesc());
         pConf->Write(_T("FontSmall"), g_pFontSmall->GetNativeFontInfoDesc());
 
+        // The engine keeps nautical miles, the configuration the distance unit in use
+        if (m_pEngine) {
+            const OdometerEngineState &state = m_pEngine->GetState();
+            UpdateDistanceUnit();
+            m_TotDist.Printf("%.1f", state.TotalDistance * 3600.0 / DistDiv);
+            m_TripDist.Printf("%.1f", state.TripDistance * 3600.0 / DistDiv);
+            m_DepTime = FormatOdometerTime(state.DepartureTime, wxT("%F %T"), "---");
+            m_ArrTime = FormatOdometerTime(state.ArrivalTime, wxT("%F %T"), "---");
+        }
+
         pConf->Write( _T("TotalDistance"), m_TotDist);
         pConf->Write( _T("TripDistance"), m_TripDist);
         pConf->Write( _T("PowerOnDelaySecs"), m_PwrOnDelSecs);
@@ -974,9 +962,13 @@ bool odometer_pi::SaveConfig(void) {
 
         pConf->Write(_T("SpeedometerMax"), g_iOdoSpeedMax);
         pConf->Write(_T("OnRouteSpeedLimit"), g_iOdoOnRoute);
+        pConf->Write(_T("DisplayFPS"), g_iOdoDisplayFPS);
+        pConf->Write(_T("WatchdogPeriods"), g_iOdoWatchdogPeriods);
         pConf->Write(_T("UTCOffset"), g_iOdoUTCOffset);
         pConf->Write(_T("SpeedUnit"), g_iOdoSpeedUnit);
         pConf->Write(_T("DistanceUnit"), g_iOdoDistanceUnit);
+        pConf->Write(_T("DistanceEngine"), g_iOdoDistanceEngine);
+        pConf->Write(_T("EllipsoidDistance"), g_bOdoEllipsoid);
 
         pConf->Write(_T("OdometerCount"), (int) m_ArrayOfOdometerWindow.GetCount());
         OdometerWindowContainer *cont = m_ArrayOfOdometerWindow.Item(0);
@@ -1039,6 +1031,10 @@ void odometer_pi::ApplyConfig(void) {
         }
     }
     m_pauimgr->Update();
+
+    // The units may have changed, rebuild everything on the next tick.
+    // Recreated instruments pull the current values from the bus themselves.
+    m_DirtyChannels = ODOMETER_OUTPUT_CHANNELS;
 }
 
 void odometer_pi::PopulateContextMenu(wxMenu* menu) {
@@ -1064,7 +1060,9 @@ void odometer_pi::ShowOdometer(size_t id, bool visible) {
 //
 //---------------------------------------------------------------------------------------------------------
 
-OdometerPreferencesDialog::OdometerPreferencesDialog(wxWindow *parent, wxWindowID id, wxArrayOfOdometer config) :
+OdometerPreferencesDialog::OdometerPreferencesDialog(wxWindow *parent, wxWindowID id, wxArrayOfOdometer config,
+        const TripHistorySummary *history, const OdometerSentenceStats *sentenceStats,
+        double distDiv, const wxString &distUnit) :
         wxDialog(parent, id, _("Odometer Settings"), wxDefaultPosition, wxDefaultSize,  wxDEFAULT_DIALOG_STYLE) {
     Connect(wxEVT_CLOSE_WINDOW, wxCloseEventHandler(OdometerPreferencesDialog::OnCloseDialog), NULL, this);
 
@@ -1180,6 +1178,20 @@ OdometerPreferencesDialog::OdometerPreferencesDialog(wxWindow *parent, wxWindowI
         wxDefaultSize, wxSP_ARROW_KEYS, 0, 5, g_iOdoOnRoute);
     itemFlexGridSizer03->Add(m_pSpinOnRoute, 0, wxALIGN_RIGHT | wxALL, 0);
 
+    wxStaticText* itemStaticText08 = new wxStaticText( m_pPanelPreferences, wxID_ANY, _("Display updates per second:"), 
+        wxDefaultPosition, wxDefaultSize, 0);
+    itemFlexGridSizer03->Add(itemStaticText08, 0, wxEXPAND | wxALL, border_size);
+    m_pSpinDisplayFPS = new wxSpinCtrl(m_pPanelPreferences, wxID_ANY, wxEmptyString, wxDefaultPosition, 
+        wxDefaultSize, wxSP_ARROW_KEYS, 1, 10, g_iOdoDisplayFPS);
+    itemFlexGridSizer03->Add(m_pSpinDisplayFPS, 0, wxALIGN_RIGHT | wxALL, 0);
+
+    wxStaticText* itemStaticText09 = new wxStaticText( m_pPanelPreferences, wxID_ANY, _("Fix stale after missed updates:"), 
+        wxDefaultPosition, wxDefaultSize, 0);
+    itemFlexGridSizer03->Add(itemStaticText09, 0, wxEXPAND | wxALL, border_size);
+    m_pSpinWatchdogPeriods = new wxSpinCtrl(m_pPanelPreferences, wxID_ANY, wxEmptyString, wxDefaultPosition, 
+        wxDefaultSize, wxSP_ARROW_KEYS, WATCHDOG_MINIMUM_PERIODS, WATCHDOG_MAXIMUM_PERIODS, g_iOdoWatchdogPeriods);
+    itemFlexGridSizer03->Add(m_pSpinWatchdogPeriods, 0, wxALIGN_RIGHT | wxALL, 0);
+
     wxStaticText* itemStaticText11 = new wxStaticText( m_pPanelPreferences, wxID_ANY, _( "Local Time Offset From UTC:" ), 
         wxDefaultPosition, wxDefaultSize, 0 );
     itemFlexGridSizer03->Add( itemStaticText11, 0, wxEXPAND | wxALL, border_size );
@@ -1220,6 +1232,79 @@ OdometerPreferencesDialog::OdometerPreferencesDialog(wxWindow *parent, wxWindowI
     m_pChoiceDistanceUnit->SetSelection( g_iOdoDistanceUnit );
     itemFlexGridSizer03->Add( m_pChoiceDistanceUnit, 0, wxALIGN_RIGHT | wxALL, 0 );
 
+    wxStaticText* itemStaticText14 = new wxStaticText( m_pPanelPreferences, wxID_ANY, _("Distance measured from:"), 
+        wxDefaultPosition, wxDefaultSize, 0 );
+    itemFlexGridSizer03->Add( itemStaticText14, 0, wxEXPAND | wxALL, border_size );
+    wxString m_DistanceEngineChoices[] = { _("Speed over ground"), _("Position"), _("Speed and position") };
+    int m_DistanceEngineNChoices = sizeof( m_DistanceEngineChoices ) / sizeof( wxString );
+    m_pChoiceDistanceEngine = new wxChoice( m_pPanelPreferences, wxID_ANY, wxDefaultPosition, wxDefaultSize, 
+        m_DistanceEngineNChoices, m_DistanceEngineChoices, 0 );
+    m_pChoiceDistanceEngine->SetSelection( g_iOdoDistanceEngine );
+    itemFlexGridSizer03->Add( m_pChoiceDistanceEngine, 0, wxALIGN_RIGHT | wxALL, 0 );
+
+    m_pCheckBoxEllipsoid = new wxCheckBox( m_pPanelPreferences, wxID_ANY, _("Ellipsoidal (WGS84) position distance"),
+        wxDefaultPosition, wxDefaultSize, 0 );
+    m_pCheckBoxEllipsoid->SetValue( g_bOdoEllipsoid );
+    itemFlexGridSizer03->Add( m_pCheckBoxEllipsoid, 0, wxEXPAND | wxALL, border_size );
+
+    // Trip history from the journal index, read only
+    if (history != NULL) {
+        wxStaticBox* itemStaticBoxHistory = new wxStaticBox( m_pPanelPreferences, wxID_ANY, _("Trip history") );
+        wxStaticBoxSizer* itemStaticBoxSizer06 = new wxStaticBoxSizer( itemStaticBoxHistory, wxHORIZONTAL );
+        itemBoxSizerMainFrame->Add( itemStaticBoxSizer06, 0, wxEXPAND | wxALL, border_size );
+        wxFlexGridSizer *itemFlexGridSizer04 = new wxFlexGridSizer( 2 );
+        itemFlexGridSizer04->AddGrowableCol( 1 );
+        itemStaticBoxSizer06->Add( itemFlexGridSizer04, 1, wxEXPAND | wxALL, 0 );
+
+        double distFactor = 3600.0 / distDiv;
+        wxString speedUnit = getUsrSpeedUnit_Plugin( g_iOdoSpeedUnit );
+
+        wxString labels[] = { _("Today:"), _("Last 7 days:"), _("This season:"), _("All time:"),
+            _("Trips:"), _("Longest trip:"), _("Maximum speed:"), _("Average speed underway:") };
+        wxString values[] = {
+            wxString::Format( _T("%.1f %s"), history->Today * distFactor, distUnit ),
+            wxString::Format( _T("%.1f %s"), history->Last7Days * distFactor, distUnit ),
+            wxString::Format( _T("%.1f %s"), history->Season * distFactor, distUnit ),
+            wxString::Format( _T("%.1f %s"), history->AllTime * distFactor, distUnit ),
+            wxString::Format( _T("%lu"), history->Trips ),
+            wxString::Format( _T("%.1f %s"), history->LongestTrip * distFactor, distUnit ),
+            wxString::Format( _T("%.1f %s"), toUsrSpeed_Plugin( history->MaxSpeed, g_iOdoSpeedUnit ), speedUnit ),
+            wxString::Format( _T("%.1f %s"), toUsrSpeed_Plugin( history->AverageSpeed, g_iOdoSpeedUnit ), speedUnit ) };
+        for (size_t i = 0; i < sizeof( labels ) / sizeof( wxString ); i++) {
+            itemFlexGridSizer04->Add( new wxStaticText( m_pPanelPreferences, wxID_ANY, labels[i] ),
+                0, wxEXPAND | wxALL, border_size );
+            itemFlexGridSizer04->Add( new wxStaticText( m_pPanelPreferences, wxID_ANY, values[i] ),
+                0, wxALIGN_RIGHT | wxALL, border_size );
+        }
+    }
+
+    // What became of the GGA and RMC sentences of each talker, read only
+    if (sentenceStats != NULL) {
+        wxStaticBox* itemStaticBoxSentences = new wxStaticBox( m_pPanelPreferences, wxID_ANY, _("Sentence statistics") );
+        wxStaticBoxSizer* itemStaticBoxSizer08 = new wxStaticBoxSizer( itemStaticBoxSentences, wxVERTICAL );
+        itemBoxSizerMainFrame->Add( itemStaticBoxSizer08, 0, wxEXPAND | wxALL, border_size );
+        wxTextCtrl *sentences = new wxTextCtrl( m_pPanelPreferences, wxID_ANY,
+            sentenceStats->Report( wxGetLocalTimeMillis().GetValue() ),
+            wxDefaultPosition, wxSize( -1, 100 ), wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP );
+        sentences->SetFont( wxFont( 8, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL ) );
+        itemStaticBoxSizer08->Add( sentences, 1, wxEXPAND | wxALL, border_size );
+    }
+
+#ifdef ODOMETER_PROFILE
+    // Latency histograms, only in builds configured with ODOMETER_PROFILE
+    wxStaticBox* itemStaticBoxDiagnostics = new wxStaticBox( m_pPanelPreferences, wxID_ANY, _("Diagnostics") );
+    wxStaticBoxSizer* itemStaticBoxSizer07 = new wxStaticBoxSizer( itemStaticBoxDiagnostics, wxVERTICAL );
+    itemBoxSizerMainFrame->Add( itemStaticBoxSizer07, 0, wxEXPAND | wxALL, border_size );
+    wxTextCtrl *diagnostics = new wxTextCtrl( m_pPanelPreferences, wxID_ANY, OdometerProfile::Get().Report(),
+        wxDefaultPosition, wxSize( -1, 160 ), wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP );
+    diagnostics->SetFont( wxFont( 8, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL ) );
+    itemStaticBoxSizer07->Add( diagnostics, 1, wxEXPAND | wxALL, border_size );
+    wxButton *saveDiagnostics = new wxButton( m_pPanelPreferences, wxID_ANY, _("Save to file...") );
+    saveDiagnostics->Connect( wxEVT_COMMAND_BUTTON_CLICKED,
+        wxCommandEventHandler( OdometerPreferencesDialog::OnSaveDiagnostics ), NULL, this );
+    itemStaticBoxSizer07->Add( saveDiagnostics, 0, wxALIGN_RIGHT | wxALL, border_size );
+#endif
+
 	wxStdDialogButtonSizer* DialogButtonSizer = CreateStdDialogButtonSizer(wxOK | wxCANCEL);
     itemBoxSizerMainPanel->Add(DialogButtonSizer, 0, wxALIGN_RIGHT | wxALL, 5);
 
@@ -1247,9 +1332,13 @@ void OdometerPreferencesDialog::SaveOdometerConfig(void) {
     
     g_iOdoSpeedMax = m_pSpinSpeedMax->GetValue();  
     g_iOdoOnRoute = m_pSpinOnRoute->GetValue(); 
+    g_iOdoDisplayFPS = m_pSpinDisplayFPS->GetValue();
+    g_iOdoWatchdogPeriods = m_pSpinWatchdogPeriods->GetValue();
     g_iOdoUTCOffset = m_pChoiceUTCOffset->GetSelection();
     g_iOdoSpeedUnit = m_pChoiceSpeedUnit->GetSelection();
     g_iOdoDistanceUnit = m_pChoiceDistanceUnit->GetSelection();
+    g_iOdoDistanceEngine = m_pChoiceDistanceEngine->GetSelection();
+    g_bOdoEllipsoid = m_pCheckBoxEllipsoid->IsChecked();
 
     OdometerWindowContainer *cont = m_Config.Item(0);
     cont->m_bIsVisible = m_pCheckBoxIsVisible->IsChecked();
@@ -1259,6 +1348,17 @@ void OdometerPreferencesDialog::SaveOdometerConfig(void) {
     cont->m_sCaption = m_pTextCtrlCaption->GetValue();
 }
 
+#ifdef ODOMETER_PROFILE
+void OdometerPreferencesDialog::OnSaveDiagnostics(wxCommandEvent& event) {
+    wxFileDialog dialog( this, _("Save diagnostics"), wxEmptyString, _T("odometer_profile.txt"),
+        _T("Text files (*.txt)|*.txt"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT );
+    if (dialog.ShowModal() != wxID_OK) return;
+    if (!OdometerProfile::Get().Dump( dialog.GetPath() )) {
+        wxMessageBox( _("Could not write ") + dialog.GetPath(), _("GPS Odometer"), wxOK | wxICON_ERROR, this );
+    }
+}
+#endif
+
 void OdometerPreferencesDialog::OnOdometerSelected(wxListEvent& event) {
     SaveOdometerConfig();
     UpdateOdometerButtonsState();
@@ -1384,6 +1484,9 @@ void OdometerWindow::SetColorScheme(PI_ColorScheme cs) {
     wxColour col;
     GetGlobalColor(_T("DASHL"), &col);
     SetBackgroundColour(col);
+    for (size_t i = 0; i < m_ArrayOfInstrument.GetCount(); i++) {
+        m_ArrayOfInstrument.Item(i)->m_pInstrument->SetColorScheme(cs);
+    }
     Refresh(false);
 }
 
@@ -1530,10 +1633,12 @@ void OdometerWindow::SetInstrumentList(wxArrayInt list) {
     SetMinSize(itemBoxSizer->GetMinSize());
 }
 
-void OdometerWindow::SendSentenceToAllInstruments(int st, double value, wxString unit) {
+// Invalidates only the instruments whose displayed value changed, the rest of
+// the panel is left alone
+void OdometerWindow::PullChannels(const OdometerChannelBus &bus) {
+    ODOMETER_PROFILE_SCOPE(PROFILE_FANOUT);
     for (size_t i = 0; i < m_ArrayOfInstrument.GetCount(); i++) {
-		if (m_ArrayOfInstrument.Item(i)->m_cap_flag & st) {
-			m_ArrayOfInstrument.Item(i)->m_pInstrument->SetData(st, value, unit);
-		}
+        OdometerInstrument *instrument = m_ArrayOfInstrument.Item(i)->m_pInstrument;
+        if (instrument->PullChannels(bus)) instrument->Refresh(false);
     }
 }
@@ -0,0 +1,145 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "odometerengine.h"
+
+OdometerEngine::OdometerEngine(OdometerClock *clock) {
+    m_Clock = clock;
+    m_State.TotalDistance = 0.0;
+    m_State.TripDistance = 0.0;
+    m_State.LegDistance = 0.0;
+    m_State.DepartureTime = ODOMETER_NO_TIME;
+    m_State.ArrivalTime = ODOMETER_NO_TIME;
+    m_State.OnRoute = false;
+    m_State.LegRunning = false;
+    m_State.LegTime = 0;
+    m_Changes = ODOMETER_CHANGED_ALL;
+    m_OnRouteSpeed = 2.0;
+    m_bLegEnabled = true;
+    m_LegStart = m_Clock->Now();
+}
+
+void OdometerEngine::SetOnRouteSpeed(double knots) {
+    m_OnRouteSpeed = knots;
+}
+
+// A disabled leg is held at zero, so it does not count while it is not shown
+void OdometerEngine::SetLegEnabled(bool enabled) {
+    m_bLegEnabled = enabled;
+    if (!enabled) {
+        if (m_State.LegDistance != 0.0) m_Changes |= ODOMETER_CHANGED_LEG_DIST;
+        m_State.LegDistance = 0.0;
+        m_LegStart = m_Clock->Now();
+        if (m_State.LegRunning) UpdateLegTime(m_LegStart);
+    }
+}
+
+void OdometerEngine::Restore(double total, double trip, OdometerTime departure, OdometerTime arrival) {
+    m_State.TotalDistance = total;
+    m_State.TripDistance = trip;
+    m_State.DepartureTime = departure;
+    m_State.ArrivalTime = arrival;
+    m_State.OnRoute = false;
+    m_Changes |= ODOMETER_CHANGED_ALL;
+}
+
+// Departure is the first time the speed reaches the on route speed after a
+// trip reset, arrival the time it drops below it again
+void OdometerEngine::OnFix(const OdometerEngineFix &fix) {
+    OdometerTime now = m_Clock->Now();
+
+    if (fix.Speed >= m_OnRouteSpeed) {
+        if (m_State.DepartureTime == ODOMETER_NO_TIME) {
+            m_State.DepartureTime = now;
+            m_Changes |= ODOMETER_CHANGED_DEPARTURE;
+        }
+        if (!m_State.OnRoute) {
+            m_State.OnRoute = true;
+            m_Changes |= ODOMETER_CHANGED_ARRIVAL;
+        }
+    } else if (m_State.OnRoute) {
+        m_State.OnRoute = false;
+        m_State.ArrivalTime = now;
+        m_Changes |= ODOMETER_CHANGED_ARRIVAL;
+    }
+
+    if (fix.Distance != 0.0) {
+        m_State.TotalDistance += fix.Distance;
+        m_State.TripDistance += fix.Distance;
+        m_Changes |= ODOMETER_CHANGED_TOTAL | ODOMETER_CHANGED_TRIP;
+
+        if (m_State.LegRunning && m_bLegEnabled) {
+            m_State.LegDistance += fix.Distance;
+            m_Changes |= ODOMETER_CHANGED_LEG_DIST;
+        }
+    }
+}
+
+// Advances the running leg time, called at least once a second
+void OdometerEngine::Tick() {
+    if (m_State.LegRunning) UpdateLegTime(m_Clock->Now());
+}
+
+void OdometerEngine::ResetTrip() {
+    m_State.TripDistance = 0.0;
+    m_State.DepartureTime = ODOMETER_NO_TIME;
+    m_State.ArrivalTime = ODOMETER_NO_TIME;
+    m_State.OnRoute = false;
+    m_Changes |= ODOMETER_CHANGED_TRIP | ODOMETER_CHANGED_DEPARTURE | ODOMETER_CHANGED_ARRIVAL;
+}
+
+void OdometerEngine::ResetLeg() {
+    m_State.LegDistance = 0.0;
+    m_State.LegTime = 0;
+    m_LegStart = m_Clock->Now();
+    m_Changes |= ODOMETER_CHANGED_LEG_DIST | ODOMETER_CHANGED_LEG_TIME;
+}
+
+// Pausing keeps the distance and time, starting again continues from them
+void OdometerEngine::StartStopLeg() {
+    OdometerTime now = m_Clock->Now();
+    if (m_State.LegRunning) {
+        UpdateLegTime(now);
+        m_State.LegRunning = false;
+    } else {
+        m_LegStart = now - m_State.LegTime;
+        m_State.LegRunning = true;
+    }
+}
+
+int OdometerEngine::TakeChanges() {
+    int changes = m_Changes;
+    m_Changes = 0;
+    return changes;
+}
+
+// Leg time is shown in whole seconds, only report it when those change
+void OdometerEngine::UpdateLegTime(OdometerTime now) {
+    OdometerTime legTime = now - m_LegStart;
+    if (legTime < 0) legTime = 0;
+    if (legTime / 1000 != m_State.LegTime / 1000) m_Changes |= ODOMETER_CHANGED_LEG_TIME;
+    m_State.LegTime = legTime;
+}
@@ -0,0 +1,154 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/file.h>
+
+#include "odometerprofile.h"
+#include <cstdio>
+#include <cstring>
+
+static const char *s_StageNames[] = {
+    "PreParse", "Parse GGA", "Parse RMC", "Distance", "Odometer", "Fan-out",
+    "Draw SOG", "Draw Sumlog", "Draw Trip", "Draw Depart", "Draw Arrival",
+    "Draw TripRes", "Draw LegDist", "Draw LegTime", "Draw StartStop", "Draw LegRes"
+};
+static_assert(sizeof(s_StageNames) / sizeof(s_StageNames[0]) == PROFILE_STAGES,
+    "A stage or channel has no name");
+
+OdometerProfile &OdometerProfile::Get() {
+    static OdometerProfile profile;
+    return profile;
+}
+
+OdometerProfile::OdometerProfile() {
+    for (int i = 0; i < PROFILE_STAGES; i++) {
+        Histogram &h = m_Stages[i];
+        h.Count.store(0);
+        h.Total.store(0);
+        h.Min.store(~0ULL);
+        h.Max.store(0);
+        for (int b = 0; b < PROFILE_BUCKETS; b++) h.Buckets[b].store(0);
+    }
+}
+
+// Values below 8 ns have a bucket each, above that every power of two is
+// split in PROFILE_SUB_BUCKETS
+int OdometerProfile::Bucket(unsigned long long ns) {
+    if (ns < PROFILE_SUB_BUCKETS) return (int) ns;
+    int exponent = 63;
+    while (!(ns & (1ULL << exponent))) exponent--;
+    int sub = (int) ((ns >> (exponent - 3)) & (PROFILE_SUB_BUCKETS - 1));
+    int bucket = (exponent - 2) * PROFILE_SUB_BUCKETS + sub;
+    return (bucket < PROFILE_BUCKETS) ? bucket : PROFILE_BUCKETS - 1;
+}
+
+// First value past a bucket
+unsigned long long OdometerProfile::BucketLimit(int bucket) {
+    if (bucket < PROFILE_SUB_BUCKETS) return bucket + 1;
+    int exponent = bucket / PROFILE_SUB_BUCKETS + 2;
+    int sub = bucket % PROFILE_SUB_BUCKETS;
+    return (unsigned long long) (PROFILE_SUB_BUCKETS + sub + 1) << (exponent - 3);
+}
+
+// Only the thread that owns the stage writes it, so plain loads and stores
+// are enough and no read-modify-write is locked
+void OdometerProfile::Record(int stage, unsigned long long ns) {
+    Histogram &h = m_Stages[stage];
+    h.Count.store(h.Count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    h.Total.store(h.Total.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    if (ns < h.Min.load(std::memory_order_relaxed)) h.Min.store(ns, std::memory_order_relaxed);
+    if (ns > h.Max.load(std::memory_order_relaxed)) h.Max.store(ns, std::memory_order_relaxed);
+    std::atomic<unsigned long> &bucket = h.Buckets[Bucket(ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Returns false for a stage without samples
+bool OdometerProfile::GetStats(int stage, OdometerProfileStats *stats) const {
+    const Histogram &h = m_Stages[stage];
+    unsigned long buckets[PROFILE_BUCKETS];
+    unsigned long count = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        buckets[b] = h.Buckets[b].load(std::memory_order_relaxed);
+        count += buckets[b];
+    }
+    if (count == 0) return false;
+
+    stats->Count = count;
+    stats->Mean = h.Total.load(std::memory_order_relaxed) / 1000.0 / count;
+    stats->Min = h.Min.load(std::memory_order_relaxed) / 1000.0;
+    stats->Max = h.Max.load(std::memory_order_relaxed) / 1000.0;
+
+    const double fractions[] = { 0.5, 0.9, 0.99, 0.999 };
+    double *percentiles[] = { &stats->P50, &stats->P90, &stats->P99, &stats->P999 };
+    unsigned long seen = 0;
+    int b = 0;
+    for (int p = 0; p < 4; p++) {
+        unsigned long rank = (unsigned long) (fractions[p] * count + 0.5);
+        if (rank < 1) rank = 1;
+        while ((b < PROFILE_BUCKETS - 1) && (seen + buckets[b] < rank)) seen += buckets[b++];
+        // The top bucket is open ended, the maximum is the better bound there
+        double limit = BucketLimit(b) / 1000.0;
+        *percentiles[p] = (limit < stats->Max) ? limit : stats->Max;
+    }
+    return true;
+}
+
+const char *OdometerProfile::StageName(int stage) {
+    return s_StageNames[stage];
+}
+
+// One line per stage with samples, times in microseconds
+wxString OdometerProfile::Report() const {
+    char line[160];
+    snprintf(line, sizeof(line), "%-15s %10s %9s %9s %9s %9s %9s %9s\n",
+        "Stage (us)", "Count", "Mean", "p50", "p90", "p99", "p99.9", "Max");
+    wxString report = wxString::FromAscii(line);
+
+    for (int i = 0; i < PROFILE_STAGES; i++) {
+        OdometerProfileStats stats;
+        if (!GetStats(i, &stats)) continue;
+        snprintf(line, sizeof(line), "%-15s %10lu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+            StageName(i), stats.Count, stats.Mean, stats.P50, stats.P90, stats.P99, stats.P999, stats.Max);
+        report += wxString::FromAscii(line);
+    }
+    return report;
+}
+
+bool OdometerProfile::Dump(const wxString &path) const {
+    wxFile file;
+    if (!file.Create(path, true)) return false;
+    wxCharBuffer text = Report().ToUTF8();
+    size_t length = strlen(text.data());
+    bool ok = (file.Write(text.data(), length) == length);
+    file.Close();
+    return ok;
+}
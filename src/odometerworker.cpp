@@ -0,0 +1,830 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "odometerworker.h"
+#include "geodesy.h"
+#include "mappedfile.h"
+#include "odometerprofile.h"
+#include <wx/time.h>
+#include <cmath>
+#include <cstring>
+
+// How often the worker wakes up to run the watchdogs when no data arrives
+#define WORKER_IDLE_TIMEOUT_MS 250
+// Earliest the worker wakes up again for a watchdog that is about due
+#define WORKER_MINIMUM_WAIT_MS 10
+
+// Sentences closer together than this arrived in one burst, not at the update rate
+#define CADENCE_MINIMUM_MS 20
+// Weight of the newest interval in the learned update period
+#define CADENCE_WEIGHT 0.2
+// After this many long intervals in a row the source has slowed down, learn afresh
+#define CADENCE_RELEARN_OUTLIERS 3
+// Shortest time after which a fix is stale, however fast the source
+#define WATCHDOG_MINIMUM_MS 200
+
+// Longest interval between two fixes that is still integrated
+#define MAXIMUM_FIX_INTERVAL_SECS 10.0
+// Fixes closer than this are taken as repeats of the same fix
+#define DUPLICATE_FIX_SECS 0.0005
+
+// Position noise radius at HDOP 1, scaled by the current HDOP
+#define JITTER_METERS_PER_HDOP 5.0
+// A position step implying more than this speed is a receiver glitch
+#define MAXIMUM_PLAUSIBLE_KNOTS 60.0
+// Below this speed the combined engine trusts the position, not the SOG
+#define STATIONARY_KNOTS 0.5
+
+// Weight of the newest fix in a source's rolling quality score
+#define SOURCE_QUALITY_WEIGHT 0.2
+// A primary source without a fix for this long, in fix time, is replaced at once.
+// Once its fix period is known, after the configured number of periods instead.
+#define SOURCE_FAILOVER_MS 2000
+// A better source only takes over when its score is higher by this margin
+#define SOURCE_SWITCH_MARGIN 0.2
+
+OdometerWorker::OdometerWorker() : wxThread(wxTHREAD_JOINABLE), m_Wakeup(0, 0) {
+    m_bStop = false;
+    m_Accepted = 0;
+    for (int i = 0; i < REJECT_CATEGORIES; i++) m_Rejected[i] = 0;
+    m_SatsRequired = 4;
+    m_HDOPLimit = 4;
+    m_PwrOnDelaySecs = 15;
+    m_DistanceEngine = DISTANCE_ENGINE_SOG;
+    m_bEllipsoid = false;
+    m_bResetTrip = false;
+    m_WatchdogPeriods = WATCHDOG_DEFAULT_PERIODS;
+
+    m_State.Sequence = 0;
+    m_State.FixSequence = 0;
+    m_State.ValidGPS = false;
+    m_State.SpeedValid = false;
+    m_State.CurrSpeed = 0.0;
+    m_State.FilteredSpeed = 0.0;
+    m_State.Distance = 0.0;
+    m_State.FixTime = -1;
+    m_State.SatsInUse = 0;
+    m_State.HDOPlevel = 100.0;
+    m_State.DuplicateFixes = 0;
+    m_State.FixGaps = 0;
+    m_State.PositionJumps = 0;
+    m_State.Source[0] = 0;
+    m_State.SourceSwitches = 0;
+    m_State.SecondaryFixes = 0;
+    m_Snapshot = m_State;
+
+    m_SourceCount = 0;
+    m_pPrimary = NULL;
+    m_GGASatsInUse = 0;
+    m_GGAHDOPlevel = 100.0;
+
+    m_GGACadence.LastArrival = -1;
+    m_GGACadence.Period = 0.0;
+    m_GGACadence.Outliers = 0;
+    mRMC_Watchdog = wxGetLocalTimeMillis().GetValue();
+    m_WatchdogWait = WORKER_IDLE_TIMEOUT_MS;
+
+    StartDelay = 1;
+    EnabledTime = 0;
+    m_bHaveFix = false;
+    m_LastFixDay = 0;
+    m_LastFixSeconds = 0.0;
+    m_LastFixSpeed = 0.0;
+    m_bHaveAnchor = false;
+    m_AnchorLatitude = 0.0;
+    m_AnchorLongitude = 0.0;
+    m_AnchorElapsed = -1.0;
+}
+
+OdometerWorker::~OdometerWorker() {
+}
+
+//---------------------------------------------------------------------------------------------------------
+//
+//    GUI thread interface
+//
+//---------------------------------------------------------------------------------------------------------
+
+// Sentences handled by ProcessSentence, everything else is dropped by Submit()
+bool OdometerWorker::IsConsumedSentence(unsigned int id) {
+    switch (id) {
+        case NMEA0183_ID_GGA:
+        case NMEA0183_ID_RMC:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Classify a sentence from its first bytes only, without copying it.
+// Returns -1 if the sentence is wanted, otherwise its REJECT_ category.
+int OdometerWorker::Prefilter(const wxString &sentence) const {
+    size_t length = sentence.Len();
+    if (length < 7) return REJECT_NOT_NMEA;
+
+    wxChar start = sentence[0];
+    if (start == '!') return REJECT_AIS;
+    if (start != '$') return REJECT_NOT_NMEA;
+    if (sentence[1] == 'P') return REJECT_PROPRIETARY;
+
+    // Normally "$ttsss," but tolerate short or long talker IDs
+    size_t comma = 6;
+    if (sentence[comma] != ',') {
+        for (comma = 4; comma < 9 && comma < length; comma++) {
+            if (sentence[comma] == ',') break;
+        }
+        if (comma >= 9 || comma >= length) return REJECT_NOT_NMEA;
+    }
+
+    wxChar a = sentence[comma - 3];
+    wxChar b = sentence[comma - 2];
+    wxChar c = sentence[comma - 1];
+    if ((unsigned long) a >= 0x80 || (unsigned long) b >= 0x80 || (unsigned long) c >= 0x80) return REJECT_NOT_NMEA;
+    if (!IsConsumedSentence(NMEA0183_SENTENCE_ID(a, b, c))) return REJECT_UNCONSUMED;
+
+    if (length >= RAW_SENTENCE_LENGTH) return REJECT_TOO_LONG;
+    return -1;
+}
+
+// Queue a raw sentence, never blocks. Returns false if the sentence was dropped.
+bool OdometerWorker::Submit(const wxString &sentence) {
+    int reject = Prefilter(sentence);
+    if (reject >= 0) {
+        m_Rejected[reject].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    RawSentence *slot = m_Ring.Claim();
+    if (!slot) {
+        m_Rejected[REJECT_OVERRUN].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    size_t length = sentence.Len();
+
+    size_t i = 0;
+    for (wxString::const_iterator it = sentence.begin(); it != sentence.end(); ++it, i++) {
+        wxChar c = *it;
+        slot->Data[i] = (c > 0 && c < 0x80) ? (char) c : '?';
+    }
+    slot->Length = (unsigned short) length;
+
+    m_Ring.Publish();
+    m_Wakeup.Post();
+    m_Accepted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void OdometerWorker::SetGates(int satsInUse, int hdop, int pwrOnDelaySecs) {
+    m_SatsRequired = satsInUse;
+    m_HDOPLimit = hdop;
+    m_PwrOnDelaySecs = pwrOnDelaySecs;
+}
+
+void OdometerWorker::SetDistanceEngine(int engine, bool ellipsoid) {
+    m_DistanceEngine = engine;
+    m_bEllipsoid = ellipsoid;
+}
+
+// Cutoff of the speedometer filter, see iirfilter. Like the journal this
+// belongs to the worker thread, so it is only set before the thread starts.
+void OdometerWorker::SetSpeedFilter(double fc) {
+    mSOGFilter.setFC(fc);
+}
+
+// A fix is stale once its source has missed this many of its update periods
+void OdometerWorker::SetWatchdogPeriods(int periods) {
+    if (periods < WATCHDOG_MINIMUM_PERIODS) periods = WATCHDOG_MINIMUM_PERIODS;
+    if (periods > WATCHDOG_MAXIMUM_PERIODS) periods = WATCHDOG_MAXIMUM_PERIODS;
+    m_WatchdogPeriods = periods;
+}
+
+// Replays the trip journal, must be called before the thread is started.
+// On entry total and trip are the distances to start a new journal with,
+// on return the distances recorded in the journal. Nautical miles.
+bool OdometerWorker::OpenJournal(const wxString &path, double *total, double *trip) {
+    if (!m_Journal.Open(path, *total, *trip)) return false;
+    *total = m_Journal.GetTotal();
+    *trip = m_Journal.GetTrip();
+    return true;
+}
+
+// Decodes a whole recorded log with the batch decoder and integrates it as
+// if it had been received, writing the fixes to the journal. Like the
+// journal, must be called before the thread is started.
+bool OdometerWorker::ImportLog(const wxString &path, NmeaBatchStats *stats) {
+    MappedFile log;
+    if (!log.OpenReadOnly(path)) return false;
+
+    NmeaBatchDecoder decoder(this);
+    decoder.Decode((const char *) log.Data(), log.Size());
+    log.Close();
+
+    Publish();
+    if (stats) *stats = decoder.GetStats();
+    return true;
+}
+
+void OdometerWorker::ResetTrip() {
+    m_bResetTrip = true;
+    m_Wakeup.Post();
+}
+
+// The index locks itself, safe to query while the worker appends to it
+bool OdometerWorker::GetHistory(TripHistorySummary *summary) {
+    long today = (long) (wxGetUTCTimeMillis().GetValue() / 86400000);
+    return m_Journal.GetIndex().GetSummary(today, summary);
+}
+
+OdometerSnapshot OdometerWorker::GetSnapshot() {
+    wxCriticalSectionLocker locker(m_SnapshotLock);
+    return m_Snapshot;
+}
+
+// Sentence counts and fix rates as of the last published snapshot
+void OdometerWorker::GetSentenceStats(OdometerSentenceStats *stats) {
+    wxCriticalSectionLocker locker(m_SnapshotLock);
+    *stats = m_PublishedStats;
+}
+
+OdometerFilterStats OdometerWorker::GetFilterStats() const {
+    OdometerFilterStats stats;
+    stats.Accepted = m_Accepted.load(std::memory_order_relaxed);
+    for (int i = 0; i < REJECT_CATEGORIES; i++) {
+        stats.Rejected[i] = m_Rejected[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+// Ask the thread to finish, the caller then joins it with Wait()
+void OdometerWorker::Stop() {
+    m_bStop = true;
+    m_Wakeup.Post();
+}
+
+// Runs the queued sentences through the parser and integrator on the
+// calling thread, so a recorded log can be replayed without the GUI or the
+// thread. Returns the number of sentences processed.
+unsigned int OdometerWorker::ProcessQueued() {
+    unsigned int count = Drain();
+    if (count > 0) Publish();
+    return count;
+}
+
+//---------------------------------------------------------------------------------------------------------
+//
+//    Worker thread
+//
+//---------------------------------------------------------------------------------------------------------
+
+wxThread::ExitCode OdometerWorker::Entry() {
+    while (!m_bStop) {
+        m_Wakeup.WaitTimeout(m_WatchdogWait);
+
+        bool changed = (Drain() > 0);
+
+        // Nothing new, commit what the journal has batched up
+        if (!changed) m_Journal.Sync();
+
+        if (CheckWatchdogs()) changed = true;
+
+        if (changed) Publish();
+    }
+
+    m_Journal.Close();
+    return (wxThread::ExitCode) 0;
+}
+
+// Process everything queued so far, returns the number of sentences
+unsigned int OdometerWorker::Drain() {
+    unsigned int count = 0;
+    const RawSentence *raw;
+    while ((raw = m_Ring.Front()) != NULL) {
+        ProcessSentence(*raw);
+        m_Ring.Release();
+        count++;
+    }
+
+    if (m_bResetTrip.exchange(false)) m_Journal.ResetTrip();
+    return count;
+}
+
+static void CopyTalker(char *talker, const wxString &id) {
+    talker[0] = (id.Len() > 0) ? (char) id[0] : 0;
+    talker[1] = (id.Len() > 1) ? (char) id[1] : 0;
+    talker[2] = 0;
+}
+
+void OdometerWorker::ProcessSentence(const RawSentence &raw) {
+    // The prefilter only queues $ttsss sentences, counted by their address field
+    char talker[3] = { 0, 0, 0 };
+    char mnemonic[4] = { 0, 0, 0, 0 };
+    if (raw.Length >= 6) {
+        memcpy(talker, raw.Data + 1, 2);
+        memcpy(mnemonic, raw.Data + 3, 3);
+    }
+    m_SentenceStats.Count(talker, mnemonic, SENTENCE_RECEIVED);
+
+    // Reuses the capacity of m_Sentence, sentences are plain ASCII
+    m_Sentence.Empty();
+    for (unsigned short i = 0; i < raw.Length; i++) {
+        m_Sentence += (wxChar) raw.Data[i];
+    }
+    m_NMEA0183 << m_Sentence;
+
+    bool preParsed;
+    {
+        ODOMETER_PROFILE_SCOPE(PROFILE_PREPARSE);
+        preParsed = m_NMEA0183.PreParse();
+    }
+
+    // Handed on in the same form as the batch decoder produces
+    if (preParsed) {
+        if (m_NMEA0183.LastSentenceIDCode == NMEA0183_ID_GGA) {
+            ODOMETER_PROFILE_SCOPE(PROFILE_PARSE_GGA);
+            if (m_NMEA0183.Parse()) {
+                NmeaGGARecord gga;
+                CopyTalker(gga.Talker, m_NMEA0183.TalkerID);
+                gga.SatsInUse = m_NMEA0183.Gga.NumberOfSatellitesInUse;
+                gga.HDOPlevel = m_NMEA0183.Gga.HorizontalDilutionOfPrecision;
+                OnGGA(gga);
+                m_SentenceStats.Count(talker, mnemonic, SENTENCE_PARSED);
+            } else if (m_NMEA0183.IsChecksumBad()) {
+                m_SentenceStats.Count(talker, mnemonic, SENTENCE_BAD_CHECKSUM);
+            }
+        }
+
+        else if (m_NMEA0183.LastSentenceIDCode == NMEA0183_ID_RMC) {
+            ODOMETER_PROFILE_SCOPE(PROFILE_PARSE_RMC);
+            if (m_NMEA0183.Parse()) {
+                RMC &parsed = m_NMEA0183.Rmc;
+                NmeaRMCRecord rmc;
+                CopyTalker(rmc.Talker, m_NMEA0183.TalkerID);
+                rmc.DataValid = (parsed.IsDataValid == NTrue);
+                rmc.SecondsOfDay = parsed.UTCSecondsOfDay;
+                rmc.DayNumber = parsed.UTCDayNumber;
+                rmc.Speed = parsed.SpeedOverGroundKnots;
+
+                // Positions are ddmm.mmmm
+                LATLONG &pos = parsed.Position;
+                rmc.HavePosition = pos.Latitude.IsDataValid() && pos.Longitude.IsDataValid();
+                rmc.Latitude = rmc.HavePosition ? NmeaDegrees(pos.Latitude.Latitude, pos.Latitude.Northing == South) : 0.0;
+                rmc.Longitude = rmc.HavePosition ? NmeaDegrees(pos.Longitude.Longitude, pos.Longitude.Easting == West) : 0.0;
+                OnRMC(rmc);
+
+                // Whether the fix was of any use, from any source
+                m_SentenceStats.Count(talker, mnemonic, SENTENCE_PARSED);
+                if (!rmc.DataValid) {
+                    m_SentenceStats.Count(talker, mnemonic, SENTENCE_INVALID);
+                } else if (!FindSource(rmc.Talker)->Valid) {
+                    m_SentenceStats.Count(talker, mnemonic, SENTENCE_GATED);
+                } else {
+                    m_SentenceStats.CountFix(talker, wxGetLocalTimeMillis().GetValue());
+                }
+            } else if (m_NMEA0183.IsChecksumBad()) {
+                m_SentenceStats.Count(talker, mnemonic, SENTENCE_BAD_CHECKSUM);
+            }
+        }
+    }
+}
+
+void OdometerWorker::OnGGA(const NmeaGGARecord &gga) {
+    OdometerSource *source = FindSource(gga.Talker);
+    wxLongLong_t now = wxGetLocalTimeMillis().GetValue();
+    LearnCadence(&source->GGA, now);
+    LearnCadence(&m_GGACadence, now);
+    source->HaveGGA = true;
+    source->SatsInUse = gga.SatsInUse;
+    source->HDOPlevel = gga.HDOPlevel;
+    m_GGASatsInUse = source->SatsInUse;
+    m_GGAHDOPlevel = source->HDOPlevel;
+    if ((m_pPrimary == NULL) || (m_pPrimary == source)) {
+        m_State.SatsInUse = source->SatsInUse;
+        m_State.HDOPlevel = source->HDOPlevel;
+    }
+}
+
+void OdometerWorker::OnRMC(const NmeaRMCRecord &rmc) {
+    OdometerSource *source = FindSource(rmc.Talker);
+    wxLongLong_t now = wxGetLocalTimeMillis().GetValue();
+    LearnCadence(&source->RMC, now);
+
+    // Gate on the talker's own GGA, a receiver that sends none uses the last one seen
+    int sats = source->HaveGGA ? source->SatsInUse : m_GGASatsInUse;
+    double hdop = source->HaveGGA ? source->HDOPlevel : m_GGAHDOPlevel;
+    source->Valid = rmc.DataValid && (sats >= m_SatsRequired) && (hdop <= m_HDOPLimit);
+
+    double score = 0.0;
+    if (source->Valid) {
+        score = 0.5 * ((sats < 12) ? sats : 12) / 12.0 + 0.5 / ((hdop > 1.0) ? hdop : 1.0);
+    }
+    source->Quality += SOURCE_QUALITY_WEIGHT * (score - source->Quality);
+    source->Fixes++;
+
+    wxLongLong_t fixTime = -1;
+    if (rmc.SecondsOfDay >= 0.0) {
+        long day = (rmc.DayNumber >= 0) ? rmc.DayNumber : m_LastFixDay;
+        fixTime = (wxLongLong_t) ((day * 86400.0 + rmc.SecondsOfDay) * 1000.0);
+    }
+    source->LastFixTime = fixTime;
+    if (fixTime >= 0) LearnCadence(&source->Fix, fixTime);
+
+    // Only one receiver is integrated, the others stand by for failover
+    if (!SelectSource(source, fixTime)) {
+        m_State.SecondaryFixes++;
+        return;
+    }
+    m_State.SatsInUse = sats;
+    m_State.HDOPlevel = hdop;
+
+    // Data verification
+    m_State.ValidGPS = false;
+    if (source->Valid) {
+        m_State.ValidGPS = true;
+        m_State.CurrSpeed = rmc.Speed;
+        m_State.FilteredSpeed = mSOGFilter.filter(m_State.CurrSpeed);
+        m_State.SpeedValid = true;
+        m_State.FixSequence++;
+        mRMC_Watchdog = now;
+
+        OdometerFix fix;
+        fix.SecondsOfDay = rmc.SecondsOfDay;
+        fix.DayNumber = rmc.DayNumber;
+        fix.Speed = m_State.CurrSpeed;
+        fix.HavePosition = rmc.HavePosition;
+        fix.Latitude = rmc.Latitude;
+        fix.Longitude = rmc.Longitude;
+        IntegrateFix(fix);
+    } else {
+        // No distance is accepted across fixes that were not valid
+        m_bHaveFix = false;
+    }
+}
+
+// The source for a talker ID, a new one replaces the least recently heard
+// standby source when all slots are taken
+OdometerSource *OdometerWorker::FindSource(const char *talker) {
+    char a = talker[0];
+    char b = a ? talker[1] : 0;
+
+    OdometerSource *oldest = NULL;
+    for (int i = 0; i < m_SourceCount; i++) {
+        OdometerSource *source = &m_Sources[i];
+        if ((source->Talker[0] == a) && (source->Talker[1] == b)) return source;
+        if ((source != m_pPrimary) && ((oldest == NULL) || (source->LastFixTime < oldest->LastFixTime))) {
+            oldest = source;
+        }
+    }
+
+    OdometerSource *source = (m_SourceCount < ODOMETER_MAX_SOURCES) ? &m_Sources[m_SourceCount++] : oldest;
+    source->Talker[0] = a;
+    source->Talker[1] = b;
+    source->Talker[2] = 0;
+    source->HaveGGA = false;
+    source->SatsInUse = 0;
+    source->HDOPlevel = 100.0;
+    source->Quality = 0.0;
+    source->Valid = false;
+    source->LastFixTime = -1;
+    source->Fixes = 0;
+    source->RMC.LastArrival = -1;
+    source->RMC.Period = 0.0;
+    source->RMC.Outliers = 0;
+    source->GGA = source->RMC;
+    source->Fix = source->RMC;
+    return source;
+}
+
+// Decides whether this RMC is integrated. The primary source is kept while
+// it delivers good fixes, another valid source takes over at once when the
+// primary fails its gates or goes quiet, or when it scores clearly better.
+bool OdometerWorker::SelectSource(OdometerSource *source, wxLongLong_t fixTime) {
+    OdometerSource *select = m_pPrimary;
+
+    if (source == m_pPrimary) {
+        if (!source->Valid) {
+            OdometerSource *standby = BestSource(fixTime, source);
+            if (standby) select = standby;
+        }
+    } else if (source->Valid) {
+        if ((m_pPrimary == NULL) || !m_pPrimary->Valid || (m_pPrimary->LastFixTime < 0) ||
+            (fixTime - m_pPrimary->LastFixTime > FailoverAfter(m_pPrimary)) ||
+            (source->Quality > m_pPrimary->Quality + SOURCE_SWITCH_MARGIN)) {
+            select = source;
+        }
+    } else if (m_pPrimary == NULL) {
+        select = source;
+    }
+
+    if (select != m_pPrimary) {
+        if (m_pPrimary) m_State.SourceSwitches++;
+
+        // Never integrate from one receiver's fix to another's, their clocks
+        // and antennas differ. The new source starts afresh.
+        if (m_bHaveFix) m_State.FixGaps++;
+        m_bHaveFix = false;
+        m_bHaveAnchor = false;
+
+        m_pPrimary = select;
+        memcpy(m_State.Source, select->Talker, sizeof(m_State.Source));
+    }
+    return (source == m_pPrimary);
+}
+
+// Fix time in ms after which a quiet primary source is replaced. Measured in
+// fix time, so sentences held up on their way to the worker do not count.
+wxLongLong_t OdometerWorker::FailoverAfter(const OdometerSource *source) const {
+    return (source->Fix.Period > 0.0) ? StaleAfter(source->Fix) : SOURCE_FAILOVER_MS;
+}
+
+// Highest scoring valid source heard within the failover time, if any
+OdometerSource *OdometerWorker::BestSource(wxLongLong_t fixTime, const OdometerSource *exclude) {
+    OdometerSource *best = NULL;
+    for (int i = 0; i < m_SourceCount; i++) {
+        OdometerSource *source = &m_Sources[i];
+        if ((source == exclude) || !source->Valid || (source->LastFixTime < 0)) continue;
+        if ((fixTime >= 0) && (fixTime - source->LastFixTime > FailoverAfter(source))) continue;
+        if ((best == NULL) || (source->Quality > best->Quality)) best = source;
+    }
+    return best;
+}
+
+// Distance travelled since the previous fix, in nautical miles. The interval
+// comes from the GPS fix times, so any update rate is integrated correctly
+// regardless of when the sentences reach the plugin.
+void OdometerWorker::IntegrateFix(const OdometerFix &fix) {
+    ODOMETER_PROFILE_SCOPE(PROFILE_DISTANCE);
+    if (fix.SecondsOfDay < 0.0) {
+        // No usable fix time, restart from the next fix
+        m_bHaveFix = false;
+        m_State.FixTime = -1;
+        return;
+    }
+
+    // Without a date keep counting days from the previous fix
+    long day = (fix.DayNumber >= 0) ? fix.DayNumber : m_LastFixDay;
+    double interval = 0.0;
+
+    if (m_bHaveFix) {
+        interval = (day - m_LastFixDay) * 86400.0 + (fix.SecondsOfDay - m_LastFixSeconds);
+
+        // Time passed midnight before the date did, or there is no date at all
+        if (interval < -43200.0) {
+            day++;
+            interval += 86400.0;
+        }
+
+        if ((interval < DUPLICATE_FIX_SECS) && (interval > -DUPLICATE_FIX_SECS)) {
+            m_State.DuplicateFixes++;
+            return;
+        }
+    }
+
+    // A receiver that missed the configured number of its fixes went stale, its
+    // fix times tell, however late the sentences reached the worker
+    double maximumInterval = MAXIMUM_FIX_INTERVAL_SECS;
+    if (m_pPrimary && (m_pPrimary->Fix.Period > 0.0)) {
+        double stale = StaleAfter(m_pPrimary->Fix) / 1000.0;
+        if (stale < maximumInterval) maximumInterval = stale;
+    }
+
+    // Speed distance, negative when the interval cannot be integrated
+    double speedStep = -1.0;
+    if (m_bHaveFix && (interval > 0.0) && (interval <= maximumInterval)) {
+        // Trapezoidal rule on the speeds at both ends of the interval
+        speedStep = interval * (m_LastFixSpeed + fix.Speed) / 2.0 / 3600.0;
+    } else if (m_bHaveFix) {
+        // Gap or time stepped back, the track in between is unknown
+        m_State.FixGaps++;
+    }
+
+    // Position distance, negative without a position
+    double positionStep = fix.HavePosition ? PositionStep(fix, m_bHaveFix ? interval : -1.0) : -1.0;
+
+    double StepDist = 0.0;
+    switch (m_DistanceEngine) {
+        case DISTANCE_ENGINE_POSITION:
+            if (positionStep > 0.0) StepDist = positionStep;
+            break;
+
+        case DISTANCE_ENGINE_COMBINED:
+            if ((speedStep >= 0.0) && ((fix.Speed >= STATIONARY_KNOTS) || (m_LastFixSpeed >= STATIONARY_KNOTS))) {
+                // Under way the speed is the better measure, keep the position anchor with it
+                StepDist = speedStep;
+                if (fix.HavePosition) {
+                    m_AnchorLatitude = fix.Latitude;
+                    m_AnchorLongitude = fix.Longitude;
+                    m_AnchorElapsed = 0.0;
+                }
+            } else if (positionStep >= 0.0) {
+                // At anchor, or across a gap the speed cannot bridge
+                StepDist = positionStep;
+            } else if (speedStep > 0.0) {
+                StepDist = speedStep;
+            }
+            break;
+
+        default:
+            if (speedStep > 0.0) StepDist = speedStep;
+            break;
+    }
+
+    /*  Are at start randomly getting extreme values for distance even if validGPS is ok.
+        Delay a minimum of 15 seconds at power up to allow everything to be properly set
+        before measuring distances. Counted in fix time, so a replayed log behaves
+        the same as live data. A receiver that starts out with a wrong date and then
+        steps back to before the delay started is delayed again from the new time. */
+    wxInt64 time = (wxInt64) ((day * 86400.0 + fix.SecondsOfDay) * 1000.0);
+    m_State.FixTime = time;
+    int PwrOnDelaySecs = m_PwrOnDelaySecs;
+    if (PwrOnDelaySecs <= 14) PwrOnDelaySecs = 15;
+    if ((StartDelay == 1) || (time < EnabledTime - PwrOnDelaySecs * 1000)) {
+       EnabledTime = time + PwrOnDelaySecs * 1000;
+       StartDelay = 0;
+    }
+    if (time <= EnabledTime) StepDist = 0.0;
+
+    m_State.Distance += StepDist;
+
+    int flags = TRIPLOG_FLAG_VALID;
+    if (fix.HavePosition) flags |= TRIPLOG_FLAG_POSITION;
+    if (speedStep < 0.0) flags |= TRIPLOG_FLAG_GAP;
+    if (fix.DayNumber < 0) flags |= TRIPLOG_FLAG_NO_DATE;
+    m_Journal.AddFix(time, fix.HavePosition ? fix.Latitude : 0.0, fix.HavePosition ? fix.Longitude : 0.0,
+        fix.Speed, StepDist, flags);
+
+    m_bHaveFix = true;
+    m_LastFixDay = day;
+    m_LastFixSeconds = fix.SecondsOfDay;
+    m_LastFixSpeed = fix.Speed;
+}
+
+// Distance from the anchor to this fix, or 0 while it stays within the
+// position noise. The anchor only moves once the boat has clearly left it,
+// so a boat swinging at anchor does not build up distance.
+double OdometerWorker::PositionStep(const OdometerFix &fix, double interval) {
+    if (!m_bHaveAnchor) {
+        m_AnchorLatitude = fix.Latitude;
+        m_AnchorLongitude = fix.Longitude;
+        m_AnchorElapsed = 0.0;
+        m_bHaveAnchor = true;
+        return 0.0;
+    }
+
+    if ((interval > 0.0) && (m_AnchorElapsed >= 0.0)) {
+        m_AnchorElapsed += interval;
+    } else {
+        m_AnchorElapsed = -1.0;
+    }
+
+    double step = GeodesicDistance(m_AnchorLatitude, m_AnchorLongitude, fix.Latitude, fix.Longitude, m_bEllipsoid);
+
+    double hdop = (m_State.HDOPlevel > 1.0) ? m_State.HDOPlevel : 1.0;
+    if (step < hdop * JITTER_METERS_PER_HDOP / METERS_PER_NM) return 0.0;
+
+    double elapsed = m_AnchorElapsed;
+    m_AnchorLatitude = fix.Latitude;
+    m_AnchorLongitude = fix.Longitude;
+    m_AnchorElapsed = 0.0;
+
+    // Restart from the new position after a jump no boat could make
+    if ((elapsed > 0.0) && (step / elapsed * 3600.0 > MAXIMUM_PLAUSIBLE_KNOTS)) {
+        m_State.PositionJumps++;
+        return 0.0;
+    }
+    return step;
+}
+
+// Learns the update period of a sentence from its arrival times, or of the
+// fixes from their fix times. Bursts and silences longer than the fixed
+// watchdog say nothing about the rate, a source that has really slowed down
+// is learned afresh after a few intervals.
+void OdometerWorker::LearnCadence(OdometerCadence *cadence, wxLongLong_t now) {
+    if (cadence->LastArrival >= 0) {
+        wxLongLong_t interval = now - cadence->LastArrival;
+        if ((interval >= CADENCE_MINIMUM_MS) && (interval <= gps_watchdog_timeout_ticks * 1000)) {
+            if (cadence->Period <= 0.0) {
+                cadence->Period = (double) interval;
+            } else if (interval > cadence->Period * m_WatchdogPeriods) {
+                if (++cadence->Outliers >= CADENCE_RELEARN_OUTLIERS) {
+                    cadence->Period = (double) interval;
+                    cadence->Outliers = 0;
+                }
+            } else {
+                cadence->Period += CADENCE_WEIGHT * (interval - cadence->Period);
+                cadence->Outliers = 0;
+            }
+        }
+    }
+    cadence->LastArrival = now;
+}
+
+// How long after its last arrival a sentence is stale, in ms. A multiple of
+// the learned period, so 300 ms on a 10 Hz receiver and 3 s on a 1 Hz one.
+wxLongLong_t OdometerWorker::StaleAfter(const OdometerCadence &cadence) const {
+    wxLongLong_t timeout = gps_watchdog_timeout_ticks * 1000;
+    if (cadence.Period <= 0.0) return timeout;
+
+    wxLongLong_t stale = (wxLongLong_t) (cadence.Period * m_WatchdogPeriods);
+    if (stale < WATCHDOG_MINIMUM_MS) stale = WATCHDOG_MINIMUM_MS;
+    return (stale < timeout) ? stale : timeout;
+}
+
+//  Manage the watchdogs, watch messages used. Returns true if the state changed.
+//  Also works out how long the worker may sleep before the next one is due.
+bool OdometerWorker::CheckWatchdogs() {
+    wxLongLong_t now = wxGetLocalTimeMillis().GetValue();
+    wxLongLong_t wait = WORKER_IDLE_TIMEOUT_MS;
+    bool changed = false;
+
+    // A receiver whose GGA stopped no longer passes the gates
+    for (int i = 0; i < m_SourceCount; i++) {
+        OdometerSource *source = &m_Sources[i];
+        if (!source->HaveGGA || (source->SatsInUse == 0) || (source->GGA.LastArrival < 0)) continue;
+
+        wxLongLong_t left = source->GGA.LastArrival + StaleAfter(source->GGA) - now;
+        if (left > 0) {
+            if (left < wait) wait = left;
+            continue;
+        }
+        m_SentenceStats.Count(source->Talker, "GGA", SENTENCE_EXPIRED);
+        source->SatsInUse = 0;
+        source->HDOPlevel = 100.0;
+        if (source == m_pPrimary) {
+            m_State.SatsInUse = 0;
+            m_State.HDOPlevel = 100.0;
+        }
+        changed = true;
+    }
+
+    // Counted once when the data stops, not every timeout after
+    if ((m_GGASatsInUse != 0) && (m_GGACadence.LastArrival >= 0)) {
+        wxLongLong_t left = m_GGACadence.LastArrival + StaleAfter(m_GGACadence) - now;
+        if (left > 0) {
+            if (left < wait) wait = left;
+        } else {
+            m_SentenceStats.Count(m_State.Source, "GGA", SENTENCE_EXPIRED);
+            m_GGASatsInUse = 0;
+            m_GGAHDOPlevel = 100.0;
+            if ((m_pPrimary == NULL) || !m_pPrimary->HaveGGA) {
+                m_State.SatsInUse = 0;
+                m_State.HDOPlevel = 100.0;
+            }
+            changed = true;
+        }
+    }
+
+    if (m_State.SpeedValid) {
+        wxLongLong_t stale = m_pPrimary ? StaleAfter(m_pPrimary->RMC) : gps_watchdog_timeout_ticks * 1000;
+        wxLongLong_t left = mRMC_Watchdog + stale - now;
+        if (left > 0) {
+            if (left < wait) wait = left;
+        } else {
+            // Only the display, sentences may just be held up on their way here.
+            // Whether the silence is bridged is decided from the fix times.
+            m_SentenceStats.Count(m_State.Source, "RMC", SENTENCE_EXPIRED);
+            m_State.SpeedValid = false;
+            changed = true;
+        }
+    }
+
+    m_WatchdogWait = (unsigned long) ((wait > WORKER_MINIMUM_WAIT_MS) ? wait : WORKER_MINIMUM_WAIT_MS);
+    return changed;
+}
+
+void OdometerWorker::Publish() {
+    m_State.Sequence++;
+
+    wxCriticalSectionLocker locker(m_SnapshotLock);
+    m_Snapshot = m_State;
+    m_PublishedStats = m_SentenceStats;
+}
@@ -64,6 +64,8 @@ void RMC::Empty( void )
    Date.Empty();
    MagneticVariation          = 0.0;
    MagneticVariationDirection = EW_Unknown;
+   UTCSecondsOfDay            = -1.0;
+   UTCDayNumber               = -1;
 }
 
 bool RMC::Parse( const SENTENCE& sentence )
@@ -101,44 +103,52 @@ bool RMC::Parse( const SENTENCE& sentence )
    */
 
    /*
-   ** First we check the checksum...
+   ** First we check the checksum, it was computed while the sentence was split
    */
 
-   int nFields = sentence.GetNumberOfDataFields( );
-   
-   NMEA0183_BOOLEAN check = sentence.IsChecksumBad( nFields + 1 );
-   
-   if ( check == NTrue )
+   if ( sentence.IsChecksumBad( ) == NTrue )
    {
-       /*
-        * * This may be an NMEA Version 3+ sentence, with added fields
-        */
-       wxString checksum_in_sentence = sentence.Field( nFields + 1 );
-       if(checksum_in_sentence.StartsWith(_T("*")))       // Field is a valid erroneous checksum
-       {
-           SetErrorMessage( _T("Invalid Checksum") );
-           return( FALSE );
-       }
+       SetErrorMessage( _T("Invalid Checksum") );
+       return( FALSE );
    }
+
+   int nFields = sentence.GetNumberOfDataFields( );
    
    //   Is this at least a 2.3 message?
    bool bext_valid = true;
-   wxString checksum_in_sentence = sentence.Field( nFields );
-   if(!checksum_in_sentence.StartsWith(_T("*"))) {
-       if((checksum_in_sentence == _T("N")) || (checksum_in_sentence == _T("S"))) 
-           bext_valid = false;
-   }
+   char mode_in_sentence = sentence.FieldCharacter( nFields );
+   if((mode_in_sentence == 'N') || (mode_in_sentence == 'S'))
+       bext_valid = false;
    
    UTCTime                    = sentence.Field( 1 );
+
+   if ( sentence.DecodeTimeOfDay( 1, &UTCSecondsOfDay ) != FieldValid )
+       UTCSecondsOfDay = -1.0;
    IsDataValid                = sentence.Boolean( 2 );
    if( !bext_valid )
        IsDataValid = NFalse;
 
    Position.Parse( 3, 4, 5, 6, sentence );
-   SpeedOverGroundKnots       = sentence.Double( 7 );
-   TrackMadeGoodDegreesTrue   = sentence.Double( 8 );
+
+   // A fix without a usable speed cannot be used for distance
+   if ( sentence.DecodeDouble( 7, &SpeedOverGroundKnots ) != FieldValid )
+   {
+       SpeedOverGroundKnots = 0.0;
+       IsDataValid = NFalse;
+   }
+
+   // Track and variation are commonly left empty
+   if ( sentence.DecodeDouble( 8, &TrackMadeGoodDegreesTrue ) != FieldValid )
+       TrackMadeGoodDegreesTrue = 0.0;
+
    Date                       = sentence.Field( 9 );
-   MagneticVariation          = sentence.Double( 10 );
+
+   if ( sentence.DecodeDate( 9, &UTCDayNumber ) != FieldValid )
+       UTCDayNumber = -1;
+
+   if ( sentence.DecodeDouble( 10, &MagneticVariation ) != FieldValid )
+       MagneticVariation = 0.0;
+
    MagneticVariationDirection = sentence.EastOrWest( 11 );
 
    return( TRUE );
@@ -180,6 +190,8 @@ const RMC& RMC::operator = ( const RMC& source )
    Date                       = source.Date;
    MagneticVariation          = source.MagneticVariation;
    MagneticVariationDirection = source.MagneticVariationDirection;
+   UTCSecondsOfDay            = source.UTCSecondsOfDay;
+   UTCDayNumber               = source.UTCDayNumber;
 
   return( *this );
 }
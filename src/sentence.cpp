@@ -44,6 +44,10 @@
 SENTENCE::SENTENCE()
 {
    Sentence.Empty();
+   m_NumberOfFields     = -1;
+   m_NumberOfDataFields = 0;
+   m_ChecksumField      = -1;
+   m_Checksum           = 0;
 }
 
 SENTENCE::~SENTENCE()
@@ -55,15 +59,14 @@ NMEA0183_BOOLEAN SENTENCE::Boolean( int field_number) const
 {
 //   ASSERT_VALID( this);
 
-   wxString field_data;
+   size_t length;
+   const char *field_data = FieldData( field_number, &length);
 
-   field_data = Field( field_number);
-
-   if (field_data.StartsWith(_T("A")))
+   if (length > 0 && field_data[ 0 ] == 'A')
    {
       return( NTrue);
    }
-   else if (field_data.StartsWith(_T("V")))
+   else if (length > 0 && field_data[ 0 ] == 'V')
    {
       return( NFalse);
    }
@@ -77,47 +80,45 @@ COMMUNICATIONS_MODE SENTENCE::CommunicationsMode( int field_number) const
 {
 //   ASSERT_VALID( this);
 
-   wxString field_data;
-
-   field_data = Field( field_number);
+   char field_data = FieldCharacter( field_number);
 
-   if (field_data == _T("d"))
+   if (field_data == 'd')
    {
       return( F3E_G3E_SimplexTelephone);
    }
-   else if (field_data == _T("e"))
+   else if (field_data == 'e')
    {
       return( F3E_G3E_DuplexTelephone);
    }
-   else if (field_data == _T("m"))
+   else if (field_data == 'm')
    {
       return( J3E_Telephone);
    }
-   else if (field_data == _T("o"))
+   else if (field_data == 'o')
    {
       return( H3E_Telephone);
    }
-   else if (field_data == _T("q"))
+   else if (field_data == 'q')
    {
       return( F1B_J2B_FEC_NBDP_TelexTeleprinter);
    }
-   else if (field_data == _T("s"))
+   else if (field_data == 's')
    {
       return( F1B_J2B_ARQ_NBDP_TelexTeleprinter);
    }
-   else if (field_data == _T("w"))
+   else if (field_data == 'w')
    {
       return( F1B_J2B_ReceiveOnlyTeleprinterDSC);
    }
-   else if (field_data == _T("x"))
+   else if (field_data == 'x')
    {
       return( A1A_MorseTapeRecorder);
    }
-   else if (field_data == _T("{"))
+   else if (field_data == '{')
    {
       return( A1A_MorseKeyHeadset);
    }
-   else if (field_data == _T("|"))
+   else if (field_data == '|')
    {
       return( F1C_F2C_F3C_FaxMachine);
    }
@@ -149,27 +150,65 @@ unsigned char SENTENCE::ComputeChecksum( void) const
 double SENTENCE::Double( int field_number) const
 {
  //  ASSERT_VALID( this);
-    wxCharBuffer abuf = Field( field_number).ToUTF8();
-    if (!abuf.data() || strlen(abuf.data()) == 0)        // badly formed sentence?
+    double value;
+    if (DecodeDouble( field_number, &value) != FieldValid)   // empty or badly formed field
         return (999.);
  
-    return( ::atof( abuf.data()));
+    return( value);
 }
 
+NMEA0183_FIELD_STATUS SENTENCE::DecodeDouble( int field_number, double *value) const
+{
+//   ASSERT_VALID( this);
 
-EASTWEST SENTENCE::EastOrWest( int field_number) const
+   size_t length;
+   const char *field_data = FieldData( field_number, &length);
+
+   return( DecimalValue( field_data, length, value));
+}
+
+NMEA0183_FIELD_STATUS SENTENCE::DecodeInteger( int field_number, int *value) const
+{
+//   ASSERT_VALID( this);
+
+   size_t length;
+   const char *field_data = FieldData( field_number, &length);
+
+   return( IntegerValue( field_data, length, value));
+}
+
+NMEA0183_FIELD_STATUS SENTENCE::DecodeTimeOfDay( int field_number, double *seconds) const
 {
 //   ASSERT_VALID( this);
 
-   wxString field_data;
+   size_t length;
+   const char *field_data = FieldData( field_number, &length);
+
+   return( TimeOfDayValue( field_data, length, seconds));
+}
+
+NMEA0183_FIELD_STATUS SENTENCE::DecodeDate( int field_number, long *days) const
+{
+//   ASSERT_VALID( this);
+
+   size_t length;
+   const char *field_data = FieldData( field_number, &length);
+
+   return( DateValue( field_data, length, days));
+}
+
+
+EASTWEST SENTENCE::EastOrWest( int field_number) const
+{
+//   ASSERT_VALID( this);
 
-   field_data = Field( field_number);
+   char field_data = FieldCharacter( field_number);
 
-   if (field_data == _T("E"))
+   if (field_data == 'E')
    {
       return( East);
    }
-   else if (field_data == _T("W"))
+   else if (field_data == 'W')
    {
       return( West);
    }
@@ -179,6 +218,36 @@ EASTWEST SENTENCE::EastOrWest( int field_number) const
    }
 }
 
+const char *SENTENCE::FieldData( int field_number, size_t *length) const
+{
+//   ASSERT_VALID( this);
+
+   if (m_NumberOfFields < 0)
+   {
+      Tokenize();
+   }
+
+   if (field_number < 0 || field_number >= m_NumberOfFields || field_number >= NMEA0183_MAX_FIELDS)
+   {
+      *length = 0;
+      return( "");
+   }
+
+   *length = m_Fields[ field_number ].Length;
+
+   return( m_Buffer.c_str() + m_Fields[ field_number ].Offset);
+}
+
+char SENTENCE::FieldCharacter( int field_number) const
+{
+//   ASSERT_VALID( this);
+
+   size_t length;
+   const char *field_data = FieldData( field_number, &length);
+
+   return( (length == 1) ? field_data[ 0 ] : 0);
+}
+
 const wxString& SENTENCE::Field( int desired_field_number) const
 {
 //   ASSERT_VALID( this);
@@ -186,67 +255,120 @@ const wxString& SENTENCE::Field( int desired_field_number) const
    static wxString return_string;
    return_string.Empty();
 
-   int index                = 1; // Skip over the $ at the begining of the sentence
-   int current_field_number = 0;
-   int string_length        = 0;
+   size_t length;
+   const char *field_data = FieldData( desired_field_number, &length);
 
-   string_length = Sentence.Len();
-
-   while( current_field_number < desired_field_number && index < string_length)
+   for (size_t index = 0; index < length; index++)
    {
-      if (Sentence[ index ] == ',' || Sentence[ index ] == '*')
-      {
-         current_field_number++;
-      }
+      return_string += (wxChar) field_data[ index ];
+   }
 
-      if (Sentence[ index ] == '*')
-          return_string += Sentence[ index ];
+   return( return_string);
+}
 
-      index++;
-   }
+int SENTENCE::GetNumberOfDataFields( void) const
+{
+//   ASSERT_VALID( this);
 
-   if (current_field_number == desired_field_number)
+   if (m_NumberOfFields < 0)
    {
-      while( index < string_length    &&
-             Sentence[ index ] != ',' &&
-             Sentence[ index ] != '*' &&
-             Sentence[ index ] != 0x00)
-      {
-         return_string += Sentence[ index ];
-         index++;
-      }
+      Tokenize();
    }
 
-
-   return( return_string);
+   return( m_NumberOfDataFields);
 }
 
-int SENTENCE::GetNumberOfDataFields( void) const
+void SENTENCE::Tokenize( void) const
 {
 //   ASSERT_VALID( this);
 
-   int index                = 1; // Skip over the $ at the begining of the sentence
-   int current_field_number = 0;
-   int string_length        = 0;
+   /*
+   ** Copy the sentence once into a byte buffer, NMEA 0183 is plain ASCII.
+   ** The buffer keeps its capacity so this does not allocate once warmed up.
+   */
 
-   string_length = Sentence.Len();
+   m_Buffer.clear();
 
-   while( index < string_length)
+   for (wxString::const_iterator it = Sentence.begin(); it != Sentence.end(); ++it)
    {
-      if (Sentence[ index ] == '*')
+      wxChar character = *it;
+
+      if (character == 0x00 || character == CARRIAGE_RETURN || character == LINE_FEED)
       {
-         return( (int) current_field_number);
+         break;
       }
 
-      if (Sentence[ index ] == ',')
+      m_Buffer += (character > 0 && character < 0x80) ? (char) character : '?';
+   }
+
+   /*
+   ** Split at ',' and '*', skipping over the $ at the begining of the sentence.
+   ** As before, the checksum field keeps its leading '*'. The checksum is
+   ** computed in the same pass, over everything up to the first '*'.
+   */
+
+   const char *buffer = m_Buffer.c_str();
+   size_t string_length = m_Buffer.length();
+   size_t field_start = 1;
+   bool checksum_seen = false;
+   unsigned char checksum = 0;
+
+   m_NumberOfFields = 0;
+   m_NumberOfDataFields = 0;
+   m_ChecksumField = -1;
+
+   if (string_length > 0xFFFF)
+   {
+      string_length = 0xFFFF;
+   }
+
+   for (size_t index = 1; index <= string_length; index++)
+   {
+      char character = (index < string_length) ? buffer[ index ] : ',';
+
+      if (character == ',' || character == '*' || index == string_length)
       {
-         current_field_number++;
+         if (m_NumberOfFields < NMEA0183_MAX_FIELDS)
+         {
+            m_Fields[ m_NumberOfFields ].Offset = (unsigned short) field_start;
+            m_Fields[ m_NumberOfFields ].Length = (unsigned short) (index - field_start);
+         }
+
+         m_NumberOfFields++;
+
+         if (!checksum_seen)
+         {
+            m_NumberOfDataFields = m_NumberOfFields - 1;
+         }
+
+         if (character == '*')
+         {
+            if (!checksum_seen && m_NumberOfFields < NMEA0183_MAX_FIELDS)
+            {
+               m_ChecksumField = m_NumberOfFields;
+            }
+
+            checksum_seen = true;
+            field_start = index;
+         }
+         else
+         {
+            field_start = index + 1;
+         }
       }
 
-      index++;
+      if (!checksum_seen && index < string_length)
+      {
+         checksum ^= (unsigned char) character;
+      }
    }
 
-   return( (int) current_field_number);
+   m_Checksum = checksum;
+
+   if (m_NumberOfFields > NMEA0183_MAX_FIELDS)
+   {
+      m_NumberOfFields = NMEA0183_MAX_FIELDS;
+   }
 }
 
 void SENTENCE::Finish( void)
@@ -259,17 +381,18 @@ void SENTENCE::Finish( void)
 
    temp_string.Printf(_T("*%02X%c%c"), (int) checksum, CARRIAGE_RETURN, LINE_FEED);
    Sentence += temp_string;
+   m_NumberOfFields = -1;
 }
 
 int SENTENCE::Integer( int field_number) const
 {
 //   ASSERT_VALID( this);
 
-    wxCharBuffer abuf = Field( field_number).ToUTF8();
-    if (!abuf.data())                            // badly formed sentence?
+    int value;
+    if (DecodeInteger( field_number, &value) != FieldValid)  // empty or badly formed field
         return 0;
     
-    return( ::atoi( abuf.data()));
+    return( value);
 }
 
 NMEA0183_BOOLEAN SENTENCE::IsChecksumBad( int checksum_field_number) const
@@ -280,35 +403,49 @@ NMEA0183_BOOLEAN SENTENCE::IsChecksumBad( int checksum_field_number) const
    ** Checksums are optional, return TRUE if an existing checksum is known to be bad
    */
 
-   wxString checksum_in_sentence = Field( checksum_field_number);
+   size_t length;
+   const char *checksum_in_sentence = FieldData( checksum_field_number, &length);
 
-   if (checksum_in_sentence == _T(""))
+   if (length == 0)
    {
       return( Unknown0183);
    }
 
-   wxString check = checksum_in_sentence.Mid( 1);
-   if (ComputeChecksum() != HexValue( check))
+   return( (ChecksumValue( checksum_in_sentence, length) != m_Checksum) ? NTrue : NFalse);
+}
+
+NMEA0183_BOOLEAN SENTENCE::IsChecksumBad( void) const
+{
+//   ASSERT_VALID( this);
+
+   /*
+   ** The checksum of the sentence as split by Tokenize(), wherever it is
+   */
+
+   if (m_NumberOfFields < 0)
    {
-      return( NTrue);
+      Tokenize();
+   }
+
+   if (m_ChecksumField < 0)
+   {
+      return( Unknown0183);
    }
 
-   return( NFalse);
+   return( IsChecksumBad( m_ChecksumField));
 }
 
 LEFTRIGHT SENTENCE::LeftOrRight( int field_number) const
 {
 //   ASSERT_VALID( this);
 
-   wxString field_data;
-
-   field_data = Field( field_number);
+   char field_data = FieldCharacter( field_number);
 
-   if (field_data == _T("L"))
+   if (field_data == 'L')
    {
       return( Left);
    }
-   else if (field_data == _T("R"))
+   else if (field_data == 'R')
    {
       return( Right);
    }
@@ -322,15 +459,13 @@ NORTHSOUTH SENTENCE::NorthOrSouth( int field_number) const
 {
 //   ASSERT_VALID( this);
 
-   wxString field_data;
+   char field_data = FieldCharacter( field_number);
 
-   field_data = Field( field_number);
-
-   if (field_data == _T("N"))
+   if (field_data == 'N')
    {
       return( North);
    }
-   else if (field_data == _T("S"))
+   else if (field_data == 'S')
    {
       return( South);
    }
@@ -344,27 +479,25 @@ REFERENCE SENTENCE::Reference( int field_number) const
 {
 //   ASSERT_VALID( this);
 
-   wxString field_data;
-
-   field_data = Field( field_number);
+   char field_data = FieldCharacter( field_number);
 
-   if (field_data == _T("B"))
+   if (field_data == 'B')
    {
       return( BottomTrackingLog);
    }
-   else if (field_data == _T("M"))
+   else if (field_data == 'M')
    {
       return( ManuallyEntered);
    }
-   else if (field_data == _T("W"))
+   else if (field_data == 'W')
    {
       return( WaterReferenced);
    }
-   else if (field_data == _T("R"))
+   else if (field_data == 'R')
    {
       return( RadarTrackingOfFixedTarget);
    }
-   else if (field_data == _T("P"))
+   else if (field_data == 'P')
    {
       return( PositioningSystemGroundReference);
    }
@@ -378,51 +511,49 @@ TRANSDUCER_TYPE SENTENCE::TransducerType( int field_number) const
 {
 //   ASSERT_VALID( this);
 
-   wxString field_data;
+   char field_data = FieldCharacter( field_number);
 
-   field_data = Field( field_number);
-
-   if (field_data == _T("A"))
+   if (field_data == 'A')
    {
       return( AngularDisplacementTransducer);
    }
-   else if (field_data == _T("D"))
+   else if (field_data == 'D')
    {
       return( LinearDisplacementTransducer);
    }
-   else if (field_data == _T("C"))
+   else if (field_data == 'C')
    {
       return( TemperatureTransducer);
    }
-   else if (field_data == _T("F"))
+   else if (field_data == 'F')
    {
       return( FrequencyTransducer);
    }
-   else if (field_data == _T("N"))
+   else if (field_data == 'N')
    {
       return( ForceTransducer);
    }
-   else if (field_data == _T("P"))
+   else if (field_data == 'P')
    {
       return( PressureTransducer);
    }
-   else if (field_data == _T("R"))
+   else if (field_data == 'R')
    {
       return( FlowRateTransducer);
    }
-   else if (field_data == _T("T"))
+   else if (field_data == 'T')
    {
       return( TachometerTransducer);
    }
-   else if (field_data == _T("H"))
+   else if (field_data == 'H')
    {
       return( HumidityTransducer);
    }
-   else if (field_data == _T("V"))
+   else if (field_data == 'V')
    {
       return( VolumeTransducer);
    }
-   else if (field_data == _T("G"))
+   else if (field_data == 'G')
    {
 	   return(GenericTransducer);
    }
@@ -449,6 +580,8 @@ const SENTENCE& SENTENCE::operator = (const SENTENCE& source)
 
    Sentence = source.Sentence;
 
+   Tokenize();
+
    return( *this);
 }
 
@@ -458,6 +591,8 @@ const SENTENCE& SENTENCE::operator = (const wxString& source)
 
    Sentence = source;
 
+   Tokenize();
+
    return( *this);
 }
 
@@ -468,6 +603,8 @@ const SENTENCE& SENTENCE::operator += (const wxString& source)
     Sentence += _T(",");
    Sentence += source;
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -482,6 +619,8 @@ const SENTENCE& SENTENCE::operator += (double value)
    Sentence += _T(",");
    Sentence += temp_string;
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -548,6 +687,8 @@ const SENTENCE& SENTENCE::operator += (COMMUNICATIONS_MODE mode)
            break;
    }
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -621,6 +762,8 @@ const SENTENCE& SENTENCE::operator += (TRANSDUCER_TYPE transducer)
 
    }
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -639,6 +782,8 @@ const SENTENCE& SENTENCE::operator += (NORTHSOUTH northing)
        Sentence += _T("S");
    }
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -653,6 +798,8 @@ const SENTENCE& SENTENCE::operator += (int value)
    Sentence += _T(",");
    Sentence += temp_string;
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -671,6 +818,8 @@ const SENTENCE& SENTENCE::operator += (EASTWEST easting)
        Sentence += _T("W");
    }
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -689,6 +838,8 @@ const SENTENCE& SENTENCE::operator += (NMEA0183_BOOLEAN boolean)
        Sentence += _T("V");
    }
 
+   m_NumberOfFields = -1;
+
    return( *this);
 }
 
@@ -0,0 +1,118 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "sentencestats.h"
+#include <cstdio>
+#include <cstring>
+
+OdometerSentenceStats::OdometerSentenceStats() {
+    memset(m_Entries, 0, sizeof(m_Entries));
+    m_Count = 0;
+}
+
+// The entry of a talker and type, once all are taken the last one counts
+// every pair not seen before
+SentenceStatsEntry *OdometerSentenceStats::Find(const char *talker, const char *mnemonic) {
+    for (int i = 0; i < m_Count; i++) {
+        SentenceStatsEntry *entry = &m_Entries[i];
+        if ((strncmp(entry->Talker, talker, 2) == 0) && (strncmp(entry->Mnemonic, mnemonic, 3) == 0)) return entry;
+    }
+
+    if (m_Count < SENTENCE_STATS_ENTRIES - 1) {
+        SentenceStatsEntry *entry = &m_Entries[m_Count++];
+        strncpy(entry->Talker, talker, 2);
+        strncpy(entry->Mnemonic, mnemonic, 3);
+        return entry;
+    }
+
+    SentenceStatsEntry *entry = &m_Entries[SENTENCE_STATS_ENTRIES - 1];
+    if (m_Count < SENTENCE_STATS_ENTRIES) {
+        strcpy(entry->Talker, "**");
+        strcpy(entry->Mnemonic, "***");
+        m_Count = SENTENCE_STATS_ENTRIES;
+    }
+    return entry;
+}
+
+void OdometerSentenceStats::Count(const char *talker, const char *mnemonic, int counter) {
+    Find(talker, mnemonic)->Counts[counter]++;
+}
+
+// An accepted fix at now, UTC milliseconds of the local clock
+void OdometerSentenceStats::CountFix(const char *talker, wxLongLong_t now) {
+    SentenceStatsEntry *entry = Find(talker, "RMC");
+    entry->Counts[SENTENCE_FIXES]++;
+
+    wxLongLong_t second = now / 1000;
+    int slot = (int) (second % SENTENCE_STATS_SLOTS);
+    if (entry->Second[slot] != second) {
+        entry->Second[slot] = second;
+        entry->Fixes[slot] = 0;
+    }
+    entry->Fixes[slot]++;
+}
+
+// Fixes per second over the last complete seconds before now
+double OdometerSentenceStats::FixRate(int index, wxLongLong_t now, int seconds) const {
+    const SentenceStatsEntry &entry = m_Entries[index];
+    wxLongLong_t last = now / 1000 - 1;
+    unsigned long fixes = 0;
+    for (int i = 0; i < SENTENCE_STATS_SLOTS; i++) {
+        if ((entry.Second[i] <= last) && (entry.Second[i] > last - seconds)) fixes += entry.Fixes[i];
+    }
+    return (double) fixes / seconds;
+}
+
+// One line per talker and type, fix rates only for RMC and only when now is given, not -1
+wxString OdometerSentenceStats::Report(wxLongLong_t now) const {
+    char line[200];
+    int length = snprintf(line, sizeof(line), "%-6s %9s %9s %8s %8s %8s %7s %9s", "Source", "Received", "Parsed",
+        "Checksum", "Invalid", "Gated", "Expired", "Fixes");
+    if (now >= 0) snprintf(line + length, sizeof(line) - length, " %6s %6s %6s", "1s", "10s", "60s");
+    wxString report = wxString::FromAscii(line) + wxString::FromAscii("\n");
+
+    for (int i = 0; i < m_Count; i++) {
+        const SentenceStatsEntry &entry = m_Entries[i];
+        char source[8];
+        snprintf(source, sizeof(source), "%.2s%.3s", entry.Talker, entry.Mnemonic);
+        const unsigned long *c = entry.Counts;
+        int length = snprintf(line, sizeof(line), "%-6s %9lu %9lu %8lu %8lu %8lu %7lu %9lu", source,
+            c[SENTENCE_RECEIVED], c[SENTENCE_PARSED], c[SENTENCE_BAD_CHECKSUM], c[SENTENCE_INVALID],
+            c[SENTENCE_GATED], c[SENTENCE_EXPIRED], c[SENTENCE_FIXES]);
+        if ((now >= 0) && (strncmp(entry.Mnemonic, "RMC", 3) == 0)) {
+            snprintf(line + length, sizeof(line) - length, " %6.1f %6.1f %6.1f",
+                FixRate(i, now, 1), FixRate(i, now, 10), FixRate(i, now, 60));
+        }
+        report += wxString::FromAscii(line) + wxString::FromAscii("\n");
+    }
+    return report;
+}
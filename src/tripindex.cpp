@@ -0,0 +1,301 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "tripindex.h"
+#include "triplog.h"
+
+#include <cstring>
+
+#define TRIPINDEX_MAGIC 0x5844494F     // "OIDX"
+#define TRIPINDEX_VERSION 1
+
+// Files grow by this many records at a time
+#define TRIPINDEX_GROW_RECORDS 256
+
+#define MS_PER_DAY 86400000LL
+
+// Same limits as the distance integration
+#define UNDERWAY_KNOTS 0.5
+#define MAXIMUM_UNDERWAY_INTERVAL_MS 10000
+
+TripIndex::TripIndex() {
+    m_LastFixTime = -1;
+}
+
+TripIndex::~TripIndex() {
+    Close();
+}
+
+// Day number of a time in milliseconds since 1970, rounding down
+static long DayOf(wxInt64 time) {
+    wxInt64 day = time / MS_PER_DAY;
+    if (time < 0 && day * MS_PER_DAY != time) day--;
+    return (long) day;
+}
+
+bool TripIndex::CheckHeader(MappedFile &file, size_t recordSize) {
+    TripIndexHeader *header = (TripIndexHeader *) file.Data();
+    return (header->Magic == TRIPINDEX_MAGIC) && (header->Version == TRIPINDEX_VERSION) &&
+        (header->RecordSize == recordSize) &&
+        (sizeof(TripIndexHeader) + (size_t) header->Count * recordSize <= file.Size());
+}
+
+void TripIndex::ResetFile(MappedFile &file, size_t recordSize) {
+    memset(file.Data(), 0, file.Size());
+    TripIndexHeader *header = (TripIndexHeader *) file.Data();
+    header->Magic = TRIPINDEX_MAGIC;
+    header->Version = TRIPINDEX_VERSION;
+    header->RecordSize = recordSize;
+}
+
+bool TripIndex::Open(const wxString &tripsPath, const wxString &daysPath) {
+    wxCriticalSectionLocker locker(m_Lock);
+
+    size_t tripsSize = sizeof(TripIndexHeader) + TRIPINDEX_GROW_RECORDS * sizeof(TripIndexEntry);
+    size_t daysSize = sizeof(TripIndexHeader) + TRIPINDEX_GROW_RECORDS * sizeof(DayIndexEntry);
+    if (!m_Trips.Open(tripsPath, tripsSize) || !m_Days.Open(daysPath, daysSize)) {
+        m_Trips.Close();
+        m_Days.Close();
+        return false;
+    }
+
+    if (!CheckHeader(m_Trips, sizeof(TripIndexEntry)) || !CheckHeader(m_Days, sizeof(DayIndexEntry))) {
+        // New, or one without the other which cannot be trusted, index the journal again
+        ResetFile(m_Trips, sizeof(TripIndexEntry));
+        ResetFile(m_Days, sizeof(DayIndexEntry));
+    }
+    m_LastFixTime = -1;
+    return true;
+}
+
+void TripIndex::Close() {
+    wxCriticalSectionLocker locker(m_Lock);
+    m_Trips.Close();
+    m_Days.Close();
+}
+
+void TripIndex::Sync() {
+    wxCriticalSectionLocker locker(m_Lock);
+    m_Trips.Sync();
+    m_Days.Sync();
+}
+
+wxInt64 TripIndex::GetIndexedOffset() {
+    wxCriticalSectionLocker locker(m_Lock);
+    return IsOpened() ? TripsHeader()->IndexedOffset : 0;
+}
+
+wxUint32 TripIndex::GetIndexedSequence() {
+    wxCriticalSectionLocker locker(m_Lock);
+    return IsOpened() ? TripsHeader()->IndexedSequence : 0;
+}
+
+// The journal was started again, index it from its beginning while keeping the history
+void TripIndex::Restart() {
+    wxCriticalSectionLocker locker(m_Lock);
+    if (!IsOpened()) return;
+    TripsHeader()->IndexedOffset = 0;
+    TripsHeader()->IndexedSequence = 0;
+    m_LastFixTime = -1;
+}
+
+// The journal ends before what was indexed, continue indexing from its end
+void TripIndex::Rewind(wxInt64 offset, wxUint32 sequence) {
+    wxCriticalSectionLocker locker(m_Lock);
+    if (!IsOpened()) return;
+    TripsHeader()->IndexedOffset = offset;
+    TripsHeader()->IndexedSequence = sequence;
+    m_LastFixTime = -1;
+}
+
+TripIndexEntry *TripIndex::TripEntry(wxUint32 index) const {
+    return (TripIndexEntry *) ((char *) m_Trips.Data() + sizeof(TripIndexHeader)) + index;
+}
+
+DayIndexEntry *TripIndex::DayEntry(wxUint32 index) const {
+    return (DayIndexEntry *) ((char *) m_Days.Data() + sizeof(TripIndexHeader)) + index;
+}
+
+// Makes room for count records, growing the file in steps
+bool TripIndex::Reserve(MappedFile &file, wxUint32 count, size_t recordSize) {
+    size_t needed = sizeof(TripIndexHeader) + (size_t) count * recordSize;
+    if (needed <= file.Size()) return true;
+
+    size_t size = file.Size();
+    while (size < needed) size += TRIPINDEX_GROW_RECORDS * recordSize;
+    return file.Resize(size);
+}
+
+TripIndexEntry *TripIndex::StartTrip(const TripLogRecord &record, wxInt64 offset) {
+    wxUint32 count = TripsHeader()->Count;
+    if (!Reserve(m_Trips, count + 1, sizeof(TripIndexEntry))) return NULL;
+
+    TripIndexEntry *trip = TripEntry(count);
+    memset(trip, 0, sizeof(TripIndexEntry));
+    trip->StartTime = record.Time;
+    trip->EndTime = record.Time;
+    trip->LogOffset = offset;
+    TripsHeader()->Count = count + 1;
+    return trip;
+}
+
+// Record of a day, appending the days in between as needed
+DayIndexEntry *TripIndex::Day(long day) {
+    TripIndexHeader *header = DaysHeader();
+    if (header->Count == 0) header->FirstDay = day;
+
+    if (day < header->FirstDay) return NULL;  // Before the history started
+    wxUint32 index = (wxUint32) (day - header->FirstDay);
+
+    if (index >= header->Count) {
+        if (!Reserve(m_Days, index + 1, sizeof(DayIndexEntry))) return NULL;
+        header = DaysHeader();
+        double cumulative = (header->Count > 0) ? DayEntry(header->Count - 1)->Cumulative : 0.0;
+        for (wxUint32 i = header->Count; i <= index; i++) {
+            DayIndexEntry *entry = DayEntry(i);
+            memset(entry, 0, sizeof(DayIndexEntry));
+            entry->Cumulative = cumulative;
+        }
+        header->Count = index + 1;
+    }
+    return DayEntry(index);
+}
+
+void TripIndex::Apply(const TripLogRecord &record, wxInt64 offset) {
+    wxCriticalSectionLocker locker(m_Lock);
+    if (!IsOpened()) return;
+
+    TripIndexHeader *header = TripsHeader();
+    if ((header->IndexedSequence != 0) && (record.Sequence <= header->IndexedSequence)) return;
+
+    if (record.Type == TRIPLOG_CHECKPOINT) {
+        if ((record.Flags & TRIPLOG_FLAG_TRIP_RESET) || (header->Count == 0)) {
+            StartTrip(record, offset);
+        }
+    } else if (record.Type == TRIPLOG_FIX) {
+        TripIndexEntry *trip = (header->Count > 0) ? TripEntry(header->Count - 1) : StartTrip(record, offset);
+        // Without a date the fix time counts on from day 0 after a start, so it
+        // cannot place the fix. It goes to the last day indexed, if there is one.
+        DayIndexEntry *day;
+        if (record.Flags & TRIPLOG_FLAG_NO_DATE) {
+            day = (DaysHeader()->Count > 0) ? DayEntry(DaysHeader()->Count - 1) : NULL;
+        } else {
+            day = Day(DayOf(record.Time));
+        }
+
+        double underway = 0.0;
+        if ((m_LastFixTime >= 0) && (record.Speed >= UNDERWAY_KNOTS) && !(record.Flags & TRIPLOG_FLAG_GAP) &&
+            (record.Time > m_LastFixTime) && (record.Time - m_LastFixTime <= MAXIMUM_UNDERWAY_INTERVAL_MS)) {
+            underway = (record.Time - m_LastFixTime) / 1000.0;
+        }
+        m_LastFixTime = record.Time;
+
+        if (trip) {
+            if (trip->Fixes == 0) trip->StartTime = record.Time;
+            trip->EndTime = record.Time;
+            trip->Distance += record.Distance;
+            trip->UnderwaySeconds += underway;
+            if (record.Speed > trip->MaxSpeed) trip->MaxSpeed = record.Speed;
+            trip->Fixes++;
+        }
+
+        if (day) {
+            day->Distance += record.Distance;
+            day->UnderwaySeconds += underway;
+            if (record.Speed > day->MaxSpeed) day->MaxSpeed = record.Speed;
+
+            // Normally the last day, a fix for an earlier day moves all later totals
+            DayIndexEntry *last = DayEntry(DaysHeader()->Count - 1);
+            for (DayIndexEntry *entry = day; entry <= last; entry++) {
+                entry->Cumulative += record.Distance;
+            }
+        }
+    }
+
+    header = TripsHeader();
+    header->IndexedOffset = offset + sizeof(TripLogRecord);
+    header->IndexedSequence = record.Sequence;
+}
+
+double TripIndex::CumulativeBefore(long day) {
+    TripIndexHeader *header = DaysHeader();
+    if ((header->Count == 0) || (day <= header->FirstDay)) return 0.0;
+    wxInt64 index = day - header->FirstDay - 1;
+    if (index >= (wxInt64) header->Count) index = header->Count - 1;
+    return DayEntry((wxUint32) index)->Cumulative;
+}
+
+double TripIndex::PeriodDistance(long firstDay, long lastDay) {
+    if (lastDay < firstDay) return 0.0;
+    return CumulativeBefore(lastDay + 1) - CumulativeBefore(firstDay);
+}
+
+double TripIndex::GetPeriodDistance(long firstDay, long lastDay) {
+    wxCriticalSectionLocker locker(m_Lock);
+    if (!IsOpened()) return 0.0;
+    return PeriodDistance(firstDay, lastDay);
+}
+
+double TripIndex::GetDayDistance(long day) {
+    return GetPeriodDistance(day, day);
+}
+
+// All totals from one consistent state of the index
+bool TripIndex::GetSummary(long today, TripHistorySummary *summary) {
+    memset(summary, 0, sizeof(TripHistorySummary));
+
+    // 1 January of the current year, from the civil date of today
+    wxDateTime date((time_t) today * 86400);
+    long yearStart = today - (date.GetDayOfYear(wxDateTime::UTC) - 1);
+
+    wxCriticalSectionLocker locker(m_Lock);
+    if (!IsOpened()) return false;
+
+    summary->Today = PeriodDistance(today, today);
+    summary->Last7Days = PeriodDistance(today - 6, today);
+    summary->Season = PeriodDistance(yearStart, today);
+    summary->AllTime = CumulativeBefore(0x7FFFFFFF);
+
+    // Trips are few, a scan is cheap
+    double underway = 0.0, underwayDistance = 0.0;
+    wxUint32 count = TripsHeader()->Count;
+    for (wxUint32 i = 0; i < count; i++) {
+        TripIndexEntry *trip = TripEntry(i);
+        if (trip->Distance > summary->LongestTrip) summary->LongestTrip = trip->Distance;
+        if (trip->MaxSpeed > summary->MaxSpeed) summary->MaxSpeed = trip->MaxSpeed;
+        underway += trip->UnderwaySeconds;
+        underwayDistance += trip->Distance;
+    }
+    if (underway > 0.0) summary->AverageSpeed = underwayDistance / (underway / 3600.0);
+    summary->Trips = count;
+    return true;
+}
@@ -0,0 +1,267 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "triplog.h"
+
+#include <wx/filefn.h>
+#include <wx/time.h>
+#include <wx/filename.h>
+#include <cstddef>
+#include <cstring>
+
+// Fixes closer together than this are merged into one record
+#define TRIPLOG_MERGE_MS 1000
+// Running totals are checkpointed at this interval of fix time
+#define TRIPLOG_CHECKPOINT_MS 60000
+
+// Seeds the checksum, so that a file of another format does not replay
+#define TRIPLOG_CHECKSUM_SEED 0x4F444F31
+
+static wxUint32 RecordChecksum(const TripLogRecord &record) {
+    // FNV-1a over everything but the checksum itself
+    const unsigned char *data = (const unsigned char *) &record;
+    wxUint32 hash = 2166136261u ^ TRIPLOG_CHECKSUM_SEED;
+    for (size_t i = 0; i < offsetof(TripLogRecord, Checksum); i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+TripLog::TripLog() {
+    m_Sequence = 0;
+    m_Total = 0.0;
+    m_Trip = 0.0;
+    m_bPending = false;
+    memset(&m_Pending, 0, sizeof(m_Pending));
+    m_LastTime = 0;
+    m_LastCheckpoint = 0;
+    m_UnsyncedRecords = 0;
+}
+
+TripLog::~TripLog() {
+    Close();
+}
+
+bool TripLog::ReadRecord(wxFileOffset index, TripLogRecord *record) {
+    if (m_File.Seek(index * sizeof(TripLogRecord)) == wxInvalidOffset) return false;
+    if (m_File.Read(record, sizeof(TripLogRecord)) != sizeof(TripLogRecord)) return false;
+    if (record->Checksum != RecordChecksum(*record)) return false;
+    return (record->Type == TRIPLOG_FIX) || (record->Type == TRIPLOG_CHECKPOINT);
+}
+
+// Opens or creates the journal and replays it. The seeds are only used when
+// there is no usable journal yet, normally the totals from the configuration.
+bool TripLog::Open(const wxString &path, double seedTotal, double seedTrip) {
+    Close();
+
+    // A journal started afresh is indexed from its beginning
+    bool fresh = !wxFileExists(path);
+    if (fresh) {
+        if (!m_File.Create(path)) return false;
+    } else if (!m_File.Open(path, wxFile::read_write)) {
+        return false;
+    }
+
+    wxFileOffset count = m_File.Length() / sizeof(TripLogRecord);
+    TripLogRecord record;
+
+    // The last checkpoint is at most a minute of records from the end
+    wxFileOffset start = count - 1;
+    while (start >= 0) {
+        if (ReadRecord(start, &record) && (record.Type == TRIPLOG_CHECKPOINT)) break;
+        start--;
+    }
+
+    wxFileOffset end = 0;
+    if (start >= 0) {
+        m_Total = record.Distance;
+        m_Trip = record.Trip;
+        m_Sequence = record.Sequence;
+        m_LastTime = record.Time;
+        m_LastCheckpoint = record.Time;
+
+        // Replay what followed, up to a torn write or stale records
+        for (end = start + 1; end < count; end++) {
+            if (!ReadRecord(end, &record) || (record.Sequence <= m_Sequence)) break;
+            m_Sequence = record.Sequence;
+            m_LastTime = record.Time;
+            if (record.Type == TRIPLOG_CHECKPOINT) {
+                m_Total = record.Distance;
+                m_Trip = record.Trip;
+                m_LastCheckpoint = record.Time;
+            } else {
+                m_Total += record.Distance;
+                m_Trip += record.Distance;
+            }
+        }
+    } else if (count > 0) {
+        // Nothing usable, keep the old file aside and start again
+        m_File.Close();
+        wxRenameFile(path, path + _T(".bad"), true);
+        if (!m_File.Create(path, true)) return false;
+        count = 0;
+        fresh = true;
+    }
+
+    // Invalidate whatever is left beyond the replayed records
+    m_File.Seek(end * sizeof(TripLogRecord));
+    if (end < count) {
+        memset(&record, 0, sizeof(record));
+        for (wxFileOffset i = end; i < count; i++) {
+            m_File.Write(&record, sizeof(record));
+        }
+        m_File.Seek(end * sizeof(TripLogRecord));
+    }
+
+    // Bring the statistics up to date with what was journaled since they were last written
+    wxFileName indexName(path);
+    indexName.SetExt(_T("trips"));
+    wxString tripsPath = indexName.GetFullPath();
+    indexName.SetExt(_T("days"));
+    if (m_Index.Open(tripsPath, indexName.GetFullPath())) {
+        if (fresh) {
+            m_Index.Restart();
+        } else if ((m_Index.GetIndexedSequence() > m_Sequence) ||
+            (m_Index.GetIndexedOffset() > (wxInt64) (end * sizeof(TripLogRecord)))) {
+            // Records were indexed before they reached the disk and then lost. They
+            // stay counted, but the new records reusing their sequence must not be skipped.
+            m_Index.Rewind(end * sizeof(TripLogRecord), m_Sequence);
+        }
+        for (wxFileOffset i = m_Index.GetIndexedOffset() / sizeof(TripLogRecord); i < end; i++) {
+            if (ReadRecord(i, &record)) m_Index.Apply(record, i * sizeof(TripLogRecord));
+        }
+        m_File.Seek(end * sizeof(TripLogRecord));
+    } else {
+        wxLogMessage(_T("GPS Odometer: Unable to open the trip index %s"), tripsPath.c_str());
+    }
+
+    if (start < 0) {
+        m_Total = seedTotal;
+        m_Trip = seedTrip;
+        m_LastTime = wxGetUTCTimeMillis().GetValue();
+        Checkpoint(0);
+    }
+    return true;
+}
+
+void TripLog::Close() {
+    if (!m_File.IsOpened()) return;
+
+    FlushPending();
+    Checkpoint(0);
+    m_File.Close();
+    m_Index.Close();
+}
+
+void TripLog::Append(TripLogRecord &record) {
+    record.Sequence = ++m_Sequence;
+    record.Reserved = 0;
+    record.Checksum = RecordChecksum(record);
+
+    m_UnsyncedOffset[m_UnsyncedRecords] = m_File.Tell();
+    m_Unsynced[m_UnsyncedRecords] = record;
+    m_File.Write(&record, sizeof(record));
+
+    if (++m_UnsyncedRecords >= TRIPLOG_SYNC_RECORDS) Sync();
+}
+
+void TripLog::FlushPending() {
+    if (!m_bPending) return;
+    Append(m_Pending);
+    m_bPending = false;
+}
+
+void TripLog::Checkpoint(int flags) {
+    TripLogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.Type = TRIPLOG_CHECKPOINT;
+    record.Flags = flags;
+    record.Time = m_LastTime;
+    record.Distance = m_Total;
+    record.Trip = m_Trip;
+    Append(record);
+    Sync();
+    m_LastCheckpoint = m_LastTime;
+}
+
+// Commits the written records to disk, then indexes them
+void TripLog::Sync() {
+    if (m_UnsyncedRecords == 0) return;
+    m_File.Flush();
+    for (int i = 0; i < m_UnsyncedRecords; i++) {
+        m_Index.Apply(m_Unsynced[i], m_UnsyncedOffset[i]);
+    }
+    m_Index.Sync();
+    m_UnsyncedRecords = 0;
+}
+
+void TripLog::AddFix(wxInt64 time, double latitude, double longitude, double speed, double distance, int flags) {
+    if (!m_File.IsOpened()) return;
+
+    m_Total += distance;
+    m_Trip += distance;
+
+    // Merge into the pending record unless a second has passed or the flags change
+    if (m_bPending && ((time - m_Pending.Time) < TRIPLOG_MERGE_MS) && (time >= m_Pending.Time) &&
+        ((flags & TRIPLOG_FLAG_GAP) == 0) && (flags == m_Pending.Flags)) {
+        m_Pending.Distance += distance;
+        m_Pending.Latitude = latitude;
+        m_Pending.Longitude = longitude;
+        m_Pending.Speed = speed;
+    } else {
+        FlushPending();
+        memset(&m_Pending, 0, sizeof(m_Pending));
+        m_Pending.Type = TRIPLOG_FIX;
+        m_Pending.Flags = flags;
+        m_Pending.Time = time;
+        m_Pending.Latitude = latitude;
+        m_Pending.Longitude = longitude;
+        m_Pending.Speed = speed;
+        m_Pending.Distance = distance;
+        m_bPending = true;
+    }
+    m_LastTime = time;
+
+    if ((time - m_LastCheckpoint >= TRIPLOG_CHECKPOINT_MS) || (time < m_LastCheckpoint)) {
+        FlushPending();
+        Checkpoint(0);
+    }
+}
+
+void TripLog::ResetTrip() {
+    if (!m_File.IsOpened()) return;
+
+    FlushPending();
+    m_Trip = 0.0;
+    Checkpoint(TRIPLOG_FLAG_TRIP_RESET);
+}
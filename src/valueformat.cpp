@@ -0,0 +1,112 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include "valueformat.h"
+#include <cmath>
+
+// The instruments show values below 999999, with up to this many decimals
+// they still scale well inside a long long
+#define VALUE_FORMAT_PRECISION_MAX 9
+
+OdometerValueFormat::OdometerValueFormat() {
+    m_bFixed = false;
+    m_bLeft = false;
+    m_Width = 0;
+    m_Precision = 6;
+    m_Scale = 1e6;
+}
+
+// Accepts a single "%[-][width][.precision]f" conversion and nothing else
+bool OdometerValueFormat::Parse(const wxString &format) {
+    m_bFixed = false;
+    m_bLeft = false;
+    m_Width = 0;
+    m_Precision = 6;
+
+    size_t length = format.Len();
+    size_t i = 0;
+    if ((i == length) || (format[i] != '%')) return false;
+    i++;
+    if ((i < length) && (format[i] == '-')) {
+        m_bLeft = true;
+        i++;
+    }
+    for (; (i < length) && wxIsdigit(format[i]); i++) {
+        m_Width = m_Width * 10 + (wxChar) format[i] - '0';
+        if (m_Width >= VALUE_FORMAT_BUFFER) return false;
+    }
+    if ((i < length) && (format[i] == '.')) {
+        m_Precision = 0;
+        for (i++; (i < length) && wxIsdigit(format[i]); i++) {
+            m_Precision = m_Precision * 10 + (wxChar) format[i] - '0';
+            if (m_Precision > VALUE_FORMAT_PRECISION_MAX) return false;
+        }
+    }
+    if ((i + 1 != length) || (format[i] != 'f')) return false;
+
+    m_Scale = 1.0;
+    for (int p = 0; p < m_Precision; p++) m_Scale *= 10.0;
+    m_bFixed = true;
+    return true;
+}
+
+// The value in units of its last shown digit, rounded half away from zero
+long long OdometerValueFormat::Scaled(double value) const {
+    return llround(value * m_Scale);
+}
+
+// Writes the scaled value with m_Precision decimals, padded to m_Width.
+// Returns the length written, not counting the terminator.
+size_t OdometerValueFormat::Print(long long scaled, char *buffer, size_t size) const {
+    char digits[VALUE_FORMAT_BUFFER];
+    int count = 0;
+    bool negative = (scaled < 0);
+    unsigned long long magnitude = negative ? 0ULL - (unsigned long long) scaled : (unsigned long long) scaled;
+
+    // Least significant digit first, with at least one digit before the point
+    do {
+        if (count == m_Precision && m_Precision > 0) digits[count++] = '.';
+        digits[count++] = (char) ('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while ((magnitude > 0 || count <= m_Precision) && (count < VALUE_FORMAT_BUFFER - 1));
+    if (negative) digits[count++] = '-';
+
+    int length = wxMax(count, m_Width);
+    if ((size_t) length >= size) length = (int) size - 1;
+
+    int pos = 0;
+    if (!m_bLeft) while (pos < length - count) buffer[pos++] = ' ';
+    while ((count > 0) && (pos < length)) buffer[pos++] = digits[--count];
+    while (pos < length) buffer[pos++] = ' ';
+    buffer[pos] = '\0';
+    return (size_t) pos;
+}
@@ -0,0 +1,599 @@
+//
+// This file is part of GPS Odometer, a plugin for OpenCPN.
+//
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GPS Odometer Plugin
+ *
+ ***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+/*
+    Headless replay of recorded NMEA logs through the odometer parser,
+    distance integrator and trip engine, as fast as they will go.
+
+    Every line of the logs is handed to OdometerWorker::Submit() exactly as
+    OpenCPN hands sentences to the plugin, then processed on this thread with
+    ProcessQueued(). The trip engine runs on the fix times of the log, so a
+    voyage is recomputed at many times real time.
+
+    The gate, delay, on route speed and filter options take comma separated
+    lists, and the logs are replayed once for every combination. Each run
+    reports its distance, departure and arrival times and the legs sailed,
+    and at the end the throughput, the time and heap allocations per
+    sentence for each sentence type are reported as a baseline for parser
+    and integrator changes.
+
+    With -b the logs are instead imported whole with OdometerWorker::ImportLog()
+    and the batch decoder. The trip engine is not run then, each run reports
+    its distance and fixes, which must match the line by line replay, and the
+    import throughput.
+
+    With -c each line of the logs is decoded by both the live path and the
+    batch decoder, and every line on which the GGA or RMC records handed to
+    OdometerWorker's sink differ is reported. tools/parity.nmea holds the
+    malformed cases the two must agree on as well.
+
+    Built with ODOMETER_PROFILE the latency histograms of the parser stages
+    are printed last.
+
+    Usage: odometer_replay [options] logfile...
+        -s list  Satellites in use required (default 4)
+        -d list  Maximum HDOP (default 4)
+        -p list  Power-on delay in seconds (default 15)
+        -o list  On route speed in knots (default 2)
+        -f list  Speedometer filter cutoff, see iirfilter (default 0.5)
+        -e n     Distance engine, 0 SOG, 1 position, 2 combined (default 0)
+        -w       Ellipsoidal (WGS84) position distance
+        -r n     Replay the logs n times per run (default 1)
+        -j path  Also write a trip journal, to include its cost. Single run only.
+        -b       Import the logs with the batch decoder
+        -c       Check that the live path and the batch decoder agree, line by line
+*/
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+  #include "wx/wx.h"
+#endif //precompiled headers
+
+#include <wx/init.h>
+
+#include "odometerworker.h"
+#include "odometerengine.h"
+#include "odometerprofile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// Heap allocations made while a sentence is processed, counted by replacing
+// the global allocation functions
+static unsigned long g_Allocations = 0;
+
+void *operator new(std::size_t size) {
+    g_Allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size) {
+    g_Allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, std::size_t) noexcept { free(p); }
+void operator delete[](void *p, std::size_t) noexcept { free(p); }
+
+struct ReplayLine {
+    wxString Sentence;
+    size_t Type;
+};
+
+struct TypeStats {
+    std::string Name;
+    unsigned long Count;
+    double Nanoseconds;
+    unsigned long Allocations;
+};
+
+// ",..." is counted as RMC, encapsulated sentences as VDM, VDO etc.
+static std::string SentenceType(const std::string &line) {
+    size_t comma = line.find(',');
+    if (comma == std::string::npos || comma < 4) return "?";
+    if (line[1] == 'P') return "P" + line.substr(2, comma - 2);
+    return line.substr(comma - 3, 3);
+}
+
+static bool LoadLog(const char *path, std::vector<ReplayLine> &lines, std::vector<TypeStats> &types,
+        std::map<std::string, size_t> &typeIndex) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "odometer_replay: cannot open %s\n", path);
+        return false;
+    }
+
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        // Skip any time stamp or other prefix a logger put in front of the sentence
+        char *start = strpbrk(buffer, "$!");
+        if (!start) continue;
+        std::string line(start);
+        while (!line.empty() && (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r')) {
+            line.erase(line.size() - 1);
+        }
+        if (line.empty()) continue;
+
+        std::string type = SentenceType(line);
+        std::map<std::string, size_t>::iterator it = typeIndex.find(type);
+        if (it == typeIndex.end()) {
+            TypeStats stats = { type, 0, 0.0, 0 };
+            it = typeIndex.insert(std::make_pair(type, types.size())).first;
+            types.push_back(stats);
+        }
+
+        // OpenCPN passes the sentence with its line ending
+        ReplayLine replay;
+        replay.Sentence = wxString::FromAscii((line + "\r\n").c_str());
+        replay.Type = it->second;
+        lines.push_back(replay);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// The records a decoder hands to the worker, at most one per line
+struct ParityRecord {
+    int Kind;                   // 0 none, 1 GGA, 2 RMC
+    NmeaGGARecord GGA;
+    NmeaRMCRecord RMC;
+};
+
+class ParitySink : public NmeaBatchSink {
+public:
+    ParitySink() { Clear(); }
+    void Clear() { memset(&Record, 0, sizeof(Record)); }
+    void OnGGA(const NmeaGGARecord &gga) { Record.Kind = 1; Record.GGA = gga; }
+    void OnRMC(const NmeaRMCRecord &rmc) { Record.Kind = 2; Record.RMC = rmc; }
+    ParityRecord Record;
+};
+
+// The live path: OdometerWorker hands what Submit() queued and the NMEA0183
+// classes parsed to its sink methods, captured here instead of integrated
+class ParityWorker : public OdometerWorker {
+public:
+    ParityWorker() { Clear(); }
+    void Clear() { memset(&Record, 0, sizeof(Record)); }
+    ParityRecord Record;
+
+private:
+    void OnGGA(const NmeaGGARecord &gga) { Record.Kind = 1; Record.GGA = gga; }
+    void OnRMC(const NmeaRMCRecord &rmc) { Record.Kind = 2; Record.RMC = rmc; }
+};
+
+static bool SameRecord(const ParityRecord &a, const ParityRecord &b) {
+    if (a.Kind != b.Kind) return false;
+    if (a.Kind == 1) {
+        return (memcmp(a.GGA.Talker, b.GGA.Talker, 3) == 0) && (a.GGA.SatsInUse == b.GGA.SatsInUse) &&
+            (a.GGA.HDOPlevel == b.GGA.HDOPlevel);
+    }
+    if (a.Kind == 2) {
+        return (memcmp(a.RMC.Talker, b.RMC.Talker, 3) == 0) && (a.RMC.DataValid == b.RMC.DataValid) &&
+            (a.RMC.SecondsOfDay == b.RMC.SecondsOfDay) && (a.RMC.DayNumber == b.RMC.DayNumber) &&
+            (a.RMC.Speed == b.RMC.Speed) && (a.RMC.HavePosition == b.RMC.HavePosition) &&
+            (a.RMC.Latitude == b.RMC.Latitude) && (a.RMC.Longitude == b.RMC.Longitude);
+    }
+    return true;
+}
+
+static void PrintRecord(const char *path, const ParityRecord &record) {
+    if (record.Kind == 1) {
+        printf("  %-6s GGA %s sats %d HDOP %.17g\n", path, record.GGA.Talker, record.GGA.SatsInUse,
+            record.GGA.HDOPlevel);
+    } else if (record.Kind == 2) {
+        printf("  %-6s RMC %s valid %d time %.17g day %ld speed %.17g position %d %.17g %.17g\n", path,
+            record.RMC.Talker, record.RMC.DataValid, record.RMC.SecondsOfDay, record.RMC.DayNumber,
+            record.RMC.Speed, record.RMC.HavePosition, record.RMC.Latitude, record.RMC.Longitude);
+    } else {
+        printf("  %-6s none\n", path);
+    }
+}
+
+// Feeds every line of a log through both decoders, returns the number of lines that differ
+static unsigned long CheckParity(const char *path, unsigned long *checked, unsigned long *decoded) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "odometer_replay: cannot open %s\n", path);
+        return 1;
+    }
+
+    ParityWorker worker;
+    ParitySink sink;
+    NmeaBatchDecoder decoder(&sink);
+    unsigned long differences = 0;
+    unsigned long lineNumber = 0;
+
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        lineNumber++;
+        std::string raw(buffer);
+        while (!raw.empty() && (raw[raw.size() - 1] == '\n' || raw[raw.size() - 1] == '\r')) {
+            raw.erase(raw.size() - 1);
+        }
+
+        // The batch decoder sees the line as logged
+        sink.Clear();
+        decoder.Decode(raw.data(), raw.size());
+
+        // The live path sees it as LoadLog() passes it, from the sentence start and with CR LF
+        worker.Clear();
+        const char *start = strpbrk(raw.c_str(), "$!");
+        if (start) {
+            worker.Submit(wxString::FromAscii((std::string(start) + "\r\n").c_str()));
+            worker.ProcessQueued();
+        }
+
+        (*checked)++;
+        if (sink.Record.Kind != 0) (*decoded)++;
+        if (SameRecord(worker.Record, sink.Record)) continue;
+        differences++;
+        printf("%s:%lu: %s\n", path, lineNumber, raw.c_str());
+        PrintRecord("live", worker.Record);
+        PrintRecord("batch", sink.Record);
+    }
+
+    fclose(file);
+    return differences;
+}
+
+// A period above the on route speed, between a departure or restart and an arrival
+struct ReplayLeg {
+    OdometerTime Start;
+    OdometerTime End;
+    double Distance;
+};
+
+struct ReplayConfig {
+    int Sats;
+    int Hdop;
+    int Delay;
+    double OnRoute;
+    double FilterFc;
+};
+
+// The trip engine sees the fix time of the log as the current time
+class ReplayClock : public OdometerClock {
+public:
+    ReplayClock() : Time(0) {}
+    OdometerTime Now() { return Time; }
+    OdometerTime Time;
+};
+
+static std::string FormatTime(OdometerTime time) {
+    if (time < 0) return "---";
+    time_t seconds = (time_t) (time / 1000);
+    char text[32];
+    struct tm *utc = gmtime(&seconds);
+    if (!utc || !strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", utc)) return "?";
+    return text;
+}
+
+// "4" or "3,4,5"
+static bool ParseList(const char *arg, std::vector<double> &values) {
+    values.clear();
+    while (*arg) {
+        char *end;
+        double value = strtod(arg, &end);
+        if (end == arg) return false;
+        values.push_back(value);
+        if (*end == ',') end++;
+        else if (*end) return false;
+        arg = end;
+    }
+    return !values.empty();
+}
+
+static void Usage() {
+    fprintf(stderr, "Usage: odometer_replay [-s sats] [-d hdop] [-p delay] [-o onroute] [-f cutoff] "
+        "[-e engine] [-w] [-r repeat] [-j journal] [-b] [-c] logfile...\n"
+        "       -s, -d, -p, -o and -f take comma separated lists, every combination is replayed\n");
+}
+
+int main(int argc, char **argv) {
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        fprintf(stderr, "odometer_replay: failed to initialize wxWidgets\n");
+        return 1;
+    }
+
+    std::vector<double> sats(1, 4);
+    std::vector<double> hdop(1, 4);
+    std::vector<double> delay(1, 15);
+    std::vector<double> onRoute(1, 2);
+    std::vector<double> filterFc(1, 0.5);
+    int engine = DISTANCE_ENGINE_SOG;
+    bool ellipsoid = false;
+    int repeat = 1;
+    const char *journal = NULL;
+    bool batch = false;
+    bool parity = false;
+
+    std::vector<ReplayLine> lines;
+    std::vector<TypeStats> types;
+    std::map<std::string, size_t> typeIndex;
+
+    int i;
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-w") == 0) {
+            ellipsoid = true;
+            continue;
+        }
+        if (strcmp(argv[i], "-b") == 0) {
+            batch = true;
+            continue;
+        }
+        if (strcmp(argv[i], "-c") == 0) {
+            parity = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            Usage();
+            return 1;
+        }
+        bool ok = true;
+        const char *option = argv[i++];
+        if (strcmp(option, "-s") == 0) ok = ParseList(argv[i], sats);
+        else if (strcmp(option, "-d") == 0) ok = ParseList(argv[i], hdop);
+        else if (strcmp(option, "-p") == 0) ok = ParseList(argv[i], delay);
+        else if (strcmp(option, "-o") == 0) ok = ParseList(argv[i], onRoute);
+        else if (strcmp(option, "-f") == 0) ok = ParseList(argv[i], filterFc);
+        else if (strcmp(option, "-e") == 0) engine = atoi(argv[i]);
+        else if (strcmp(option, "-r") == 0) repeat = atoi(argv[i]);
+        else if (strcmp(option, "-j") == 0) journal = argv[i];
+        else ok = false;
+        if (!ok) {
+            Usage();
+            return 1;
+        }
+    }
+    if (i >= argc) {
+        Usage();
+        return 1;
+    }
+    int firstLog = i;
+    if (parity) {
+        unsigned long checked = 0;
+        unsigned long decoded = 0;
+        unsigned long differences = 0;
+        for (; i < argc; i++) differences += CheckParity(argv[i], &checked, &decoded);
+        printf("%lu lines checked, %lu decoded to GGA or RMC, %lu differ\n", checked, decoded, differences);
+        return differences ? 1 : 0;
+    }
+    if (!batch) {
+        for (; i < argc; i++) {
+            if (!LoadLog(argv[i], lines, types, typeIndex)) return 1;
+        }
+    }
+
+    std::vector<ReplayConfig> configs;
+    for (size_t a = 0; a < sats.size(); a++)
+    for (size_t b = 0; b < hdop.size(); b++)
+    for (size_t c = 0; c < delay.size(); c++)
+    for (size_t d = 0; d < onRoute.size(); d++)
+    for (size_t e = 0; e < filterFc.size(); e++) {
+        ReplayConfig config = { (int) sats[a], (int) hdop[b], (int) delay[c], onRoute[d], filterFc[e] };
+        configs.push_back(config);
+    }
+    if (journal && configs.size() > 1) {
+        fprintf(stderr, "odometer_replay: a journal can only be written by a single run\n");
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    double replaySeconds = 0.0;
+    OdometerFilterStats filter;
+    OdometerSentenceStats sentenceStats;
+    NmeaBatchStats imported;
+    memset(&imported, 0, sizeof(imported));
+    unsigned long long importedBytes = 0;
+
+    for (size_t run = 0; run < configs.size(); run++) {
+        const ReplayConfig &config = configs[run];
+
+        // Created but never run, sentences are processed on this thread
+        OdometerWorker *worker = new OdometerWorker();
+        worker->SetGates(config.Sats, config.Hdop, config.Delay);
+        worker->SetDistanceEngine(engine, ellipsoid);
+        worker->SetSpeedFilter(config.FilterFc);
+        if (journal) {
+            double total = 0.0;
+            double trip = 0.0;
+            if (!worker->OpenJournal(wxString::FromAscii(journal), &total, &trip)) {
+                fprintf(stderr, "odometer_replay: cannot open journal %s\n", journal);
+                return 1;
+            }
+        }
+
+        ReplayClock clock;
+        OdometerEngine trip(&clock);
+        trip.SetOnRouteSpeed(config.OnRoute);
+
+        std::vector<ReplayLeg> legs;
+        unsigned long lastFixSequence = 0;
+        double lastDistance = 0.0;
+        double maxShownSpeed = 0.0;
+        OdometerTime firstFixTime = -1;
+        OdometerSnapshot snapshot = worker->GetSnapshot();
+
+        Clock::time_point runStart = Clock::now();
+        double runSeconds = 0.0;
+
+        for (int pass = 0; batch && pass < repeat; pass++) {
+            for (int n = firstLog; n < argc; n++) {
+                NmeaBatchStats stats;
+                Clock::time_point start = Clock::now();
+                if (!worker->ImportLog(wxString::FromAscii(argv[n]), &stats)) {
+                    fprintf(stderr, "odometer_replay: cannot import %s\n", argv[n]);
+                    return 1;
+                }
+                runSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+                imported.Lines += stats.Lines;
+                imported.GGA += stats.GGA;
+                imported.RMC += stats.RMC;
+                imported.BadChecksums += stats.BadChecksums;
+                imported.TooLong += stats.TooLong;
+                imported.Skipped += stats.Skipped;
+                FILE *file = fopen(argv[n], "rb");
+                if (file) {
+                    fseek(file, 0, SEEK_END);
+                    importedBytes += ftell(file);
+                    fclose(file);
+                }
+            }
+            snapshot = worker->GetSnapshot();
+        }
+
+        for (int pass = 0; !batch && pass < repeat; pass++) {
+            for (size_t n = 0; n < lines.size(); n++) {
+                const ReplayLine &line = lines[n];
+                unsigned long allocations = g_Allocations;
+                Clock::time_point start = Clock::now();
+
+                worker->Submit(line.Sentence);
+                bool processed = (worker->ProcessQueued() > 0);
+
+                Clock::time_point end = Clock::now();
+                TypeStats &stats = types[line.Type];
+                stats.Count++;
+                stats.Nanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+                stats.Allocations += g_Allocations - allocations;
+                runSeconds += std::chrono::duration<double>(end - start).count();
+
+                // Drive the trip engine as the plugin does, once per new fix
+                if (!processed) continue;
+                snapshot = worker->GetSnapshot();
+                if (snapshot.FixSequence == lastFixSequence) continue;
+                lastFixSequence = snapshot.FixSequence;
+
+                if (snapshot.FixTime >= 0) {
+                    clock.Time = snapshot.FixTime;
+                    if (firstFixTime < 0) firstFixTime = snapshot.FixTime;
+                }
+                if (snapshot.FilteredSpeed > maxShownSpeed) maxShownSpeed = snapshot.FilteredSpeed;
+
+                bool wasOnRoute = trip.GetState().OnRoute;
+                OdometerEngineFix fix;
+                fix.Speed = snapshot.CurrSpeed;
+                fix.Distance = snapshot.Distance - lastDistance;
+                lastDistance = snapshot.Distance;
+                trip.OnFix(fix);
+
+                const OdometerEngineState &state = trip.GetState();
+                if (state.OnRoute && !wasOnRoute) {
+                    ReplayLeg leg = { clock.Time, -1, 0.0 };
+                    legs.push_back(leg);
+                }
+                if (wasOnRoute || state.OnRoute) legs.back().Distance += fix.Distance;
+                if (!state.OnRoute && wasOnRoute) legs.back().End = clock.Time;
+            }
+        }
+
+        replaySeconds += runSeconds;
+        double wallSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+        double logSeconds = (firstFixTime >= 0) ? (clock.Time - firstFixTime) / 1000.0 : 0.0;
+        const OdometerEngineState &state = trip.GetState();
+
+        printf("Run %lu: sats %d, HDOP %d, delay %d s, on route %.1f kn, filter %.3f\n", (unsigned long) run + 1,
+            config.Sats, config.Hdop, config.Delay, config.OnRoute, config.FilterFc);
+        if (batch) {
+            printf("  Distance %.3f NM imported in %.3f s\n", snapshot.Distance, wallSeconds);
+        } else {
+            printf("  Distance %.3f NM in %.0f s of fixes, %.0f times real time\n", state.TripDistance, logSeconds,
+                wallSeconds > 0.0 ? logSeconds / wallSeconds : 0.0);
+        }
+        printf("  Fixes %lu, duplicates %lu, gaps %lu, position jumps %lu", snapshot.FixSequence,
+            snapshot.DuplicateFixes, snapshot.FixGaps, snapshot.PositionJumps);
+        if (!batch) printf(", highest speed shown %.1f kn", maxShownSpeed);
+        printf("\n");
+        printf("  Source %s, %lu source switches, %lu standby fixes not integrated\n",
+            snapshot.Source[0] ? snapshot.Source : "none", snapshot.SourceSwitches, snapshot.SecondaryFixes);
+        if (!batch) {
+            printf("  Departure %s, arrival %s UTC\n", FormatTime(state.DepartureTime).c_str(),
+                state.OnRoute ? "on route" : FormatTime(state.ArrivalTime).c_str());
+        }
+        for (size_t n = 0; n < legs.size(); n++) {
+            printf("  Leg %-3lu %s - %s  %8.3f NM\n", (unsigned long) n + 1, FormatTime(legs[n].Start).c_str(),
+                legs[n].End < 0 ? "on route           " : FormatTime(legs[n].End).c_str(), legs[n].Distance);
+        }
+        printf("\n");
+
+        filter = worker->GetFilterStats();
+        worker->GetSentenceStats(&sentenceStats);
+        delete worker;
+    }
+
+    if (batch) {
+        printf("Imported:             %llu bytes in %.3f s, %.1f MB/s\n", importedBytes, replaySeconds,
+            replaySeconds > 0.0 ? importedBytes / replaySeconds / 1e6 : 0.0);
+        printf("Lines:                %lu, %.0f lines/s\n", imported.Lines,
+            replaySeconds > 0.0 ? imported.Lines / replaySeconds : 0.0);
+        printf("GGA %lu, RMC %lu, bad checksums %lu, too long %lu, skipped %lu\n", imported.GGA, imported.RMC,
+            imported.BadChecksums, imported.TooLong, imported.Skipped);
+        return 0;
+    }
+
+    unsigned long sentences = (unsigned long) lines.size() * repeat * configs.size();
+    printf("Sentences:            %lu in %.3f s, %.0f sentences/s\n", sentences, replaySeconds,
+        replaySeconds > 0.0 ? sentences / replaySeconds : 0.0);
+    printf("\n%-8s %10s %12s %16s\n", "Type", "Count", "ns/sentence", "allocs/sentence");
+    for (size_t n = 0; n < types.size(); n++) {
+        const TypeStats &stats = types[n];
+        if (stats.Count == 0) continue;
+        printf("%-8s %10lu %12.1f %16.2f\n", stats.Name.c_str(), stats.Count,
+            stats.Nanoseconds / stats.Count, (double) stats.Allocations / stats.Count);
+    }
+
+    static const char *rejectNames[REJECT_CATEGORIES] = {
+        "AIS", "proprietary", "not NMEA", "unconsumed", "too long", "overrun"
+    };
+    printf("\nPer run:\nAccepted:             %lu\n", filter.Accepted);
+    for (int n = 0; n < REJECT_CATEGORIES; n++) {
+        if (filter.Rejected[n]) printf("Rejected %-12s %lu\n", rejectNames[n], filter.Rejected[n]);
+    }
+
+    // The fix rates are per second of arrival, which a replay does not have
+    printf("\nLast run:\n%s", (const char *) sentenceStats.Report(-1).mb_str());
+#ifdef ODOMETER_PROFILE
+    printf("\n%s", (const char *) OdometerProfile::Get().Report().mb_str());
+#endif
+    return 0;
+}